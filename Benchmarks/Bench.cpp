@@ -0,0 +1,498 @@
+/******************************************************************************\
+* Bench.cpp                                                                    *
+* Headless benchmark of the OSGUIsh picking and dispatching path.              *
+* Leandro Motta Barros                                                         *
+\******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <osg/FrameStamp>
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/Math>
+#include <osg/Timer>
+#include <osg/View>
+#include <osgGA/GUIActionAdapter>
+#include <OSGUIsh/EventHandler.hpp>
+
+#define OSGUISH_DEFINE_ALLOCATION_COUNTER
+#include <OSGUIsh/AllocationCounter.hpp>
+
+
+//
+// Benchmark parameters
+//
+
+struct Options
+{
+   Options()
+      : numNodes(1000), depth(4), trianglesPerNode(32), numMasks(1),
+        numFrames(10000), pickerRadius(0.0), path("sweep"),
+        warmupFrames(100), maxNodesVisited(-1), maxAllocations(-1),
+        maxLookups(-1)
+   { }
+
+   /// The number of nodes registered with the \c EventHandler.
+   int numNodes;
+
+   /// The length of the node path from the root to each registered node.
+   int depth;
+
+   /// The number of triangles under each registered node.
+   int trianglesPerNode;
+
+   /// The number of picking masks (nodes are spread among them).
+   int numMasks;
+
+   /// The number of frames to run.
+   int numFrames;
+
+   /// The picker radius; zero means using a line segment intersector.
+   double pickerRadius;
+
+   /// The cursor path: "sweep", "circle" or "random".
+   std::string path;
+
+   /// The file to write JSON results to; empty means the standard output.
+   std::string jsonFile;
+
+   /// The number of initial frames not checked against the budgets.
+   int warmupFrames;
+
+   /// Budget: nodes visited when picking, per frame (negative: no budget).
+   long maxNodesVisited;
+
+   /// Budget: allocations in the frame path, per frame (negative: none).
+   long maxAllocations;
+
+   /**
+    * Budget: registered node lookups done when picking, per frame
+    * (negative: no budget). In the scenes built here, this should be \c
+    * depth, regardless of the number of nodes.
+    */
+   long maxLookups;
+};
+
+
+/// The size of the fake window, in pixels.
+const int WINDOW_SIZE = 1024;
+
+
+//
+// A view that doesn't need a window
+//
+
+class HeadlessView: public osg::View, public osgGA::GUIActionAdapter
+{
+   public:
+      HeadlessView()
+      {
+         setFrameStamp(new osg::FrameStamp());
+         getCamera()->setViewport(0, 0, WINDOW_SIZE, WINDOW_SIZE);
+      }
+
+      virtual void requestRedraw() { }
+      virtual void requestContinuousUpdate(bool) { }
+      virtual void requestWarpPointer(float, float) { }
+};
+
+
+//
+// The event handlers (they just count events)
+//
+
+std::size_t NumEnterEvents = 0;
+std::size_t NumMoveEvents = 0;
+std::size_t NumClickEvents = 0;
+
+void HandleMouseEnter(OSGUIsh::HandlerParams&) { ++NumEnterEvents; }
+void HandleMouseMove(OSGUIsh::HandlerParams&) { ++NumMoveEvents; }
+void HandleClick(OSGUIsh::HandlerParams&) { ++NumClickEvents; }
+
+
+// - CreateTriangles -----------------------------------------------------------
+osg::ref_ptr<osg::Geode> CreateTriangles(float x0, float y0, float size,
+                                         int numTriangles)
+{
+   // Columns of two triangles each, tiling (most of) a square cell
+   const int numColumns = (numTriangles + 1) / 2;
+   const float margin = size * 0.05f;
+   const float width = (size - 2 * margin) / numColumns;
+   const float yMin = y0 + margin;
+   const float yMax = y0 + size - margin;
+
+   osg::ref_ptr<osg::Vec3Array> vertices(new osg::Vec3Array());
+
+   for (int i = 0; i < numTriangles; ++i)
+   {
+      const float xMin = x0 + margin + (i / 2) * width;
+      const float xMax = xMin + width;
+
+      if (i % 2 == 0)
+      {
+         vertices->push_back(osg::Vec3(xMin, yMin, 0.0f));
+         vertices->push_back(osg::Vec3(xMax, yMin, 0.0f));
+         vertices->push_back(osg::Vec3(xMax, yMax, 0.0f));
+      }
+      else
+      {
+         vertices->push_back(osg::Vec3(xMin, yMin, 0.0f));
+         vertices->push_back(osg::Vec3(xMax, yMax, 0.0f));
+         vertices->push_back(osg::Vec3(xMin, yMax, 0.0f));
+      }
+   }
+
+   osg::ref_ptr<osg::Geometry> geometry(new osg::Geometry());
+   geometry->setVertexArray(vertices);
+   geometry->addPrimitiveSet(
+      new osg::DrawArrays(osg::PrimitiveSet::TRIANGLES, 0, vertices->size()));
+
+   osg::ref_ptr<osg::Geode> geode(new osg::Geode());
+   geode->addDrawable(geometry);
+
+   return geode;
+}
+
+
+// - CreateScene ---------------------------------------------------------------
+osg::ref_ptr<osg::Group> CreateScene(const Options& options,
+                                     OSGUIsh::EventHandler& eh,
+                                     float& sceneSize)
+{
+   const int side = static_cast<int>(
+      std::ceil(std::sqrt(static_cast<double>(options.numNodes))));
+   sceneSize = static_cast<float>(side);
+
+   osg::ref_ptr<osg::Group> root(new osg::Group());
+
+   for (int i = 0; i < options.numNodes; ++i)
+   {
+      // The registered node, and a chain of groups below it
+      osg::ref_ptr<osg::Group> registered(new osg::Group());
+      registered->setNodeMask(1u << (i % options.numMasks));
+      root->addChild(registered);
+
+      osg::ref_ptr<osg::Group> parent = registered;
+      for (int d = 2; d < options.depth; ++d)
+      {
+         osg::ref_ptr<osg::Group> child(new osg::Group());
+         parent->addChild(child);
+         parent = child;
+      }
+
+      parent->addChild(CreateTriangles(static_cast<float>(i % side),
+                                       static_cast<float>(i / side), 1.0f,
+                                       options.trianglesPerNode).get());
+
+      eh.addNode(registered);
+   }
+
+   return root;
+}
+
+
+// - GetCursorPosition ---------------------------------------------------------
+void GetCursorPosition(const std::string& path, int frame, int numFrames,
+                       float& x, float& y)
+{
+   if (path == "circle")
+   {
+      const double angle = 2.0 * osg::PI * frame / 360.0;
+      x = static_cast<float>(WINDOW_SIZE * (0.5 + 0.4 * std::cos(angle)));
+      y = static_cast<float>(WINDOW_SIZE * (0.5 + 0.4 * std::sin(angle)));
+   }
+   else if (path == "random")
+   {
+      // A deterministic pseudo random walk (a simple LCG)
+      static unsigned long state = 12345;
+      static float rx = WINDOW_SIZE / 2.0f;
+      static float ry = WINDOW_SIZE / 2.0f;
+
+      state = state * 1103515245 + 12345;
+      rx += static_cast<float>((state >> 16) % 21) - 10.0f;
+      state = state * 1103515245 + 12345;
+      ry += static_cast<float>((state >> 16) % 21) - 10.0f;
+
+      rx = std::min(std::max(rx, 0.0f), static_cast<float>(WINDOW_SIZE));
+      ry = std::min(std::max(ry, 0.0f), static_cast<float>(WINDOW_SIZE));
+
+      x = rx;
+      y = ry;
+   }
+   else // "sweep"
+   {
+      // Raster the whole window, row by row
+      const int numRows = std::max(1, static_cast<int>(std::sqrt(
+         static_cast<double>(numFrames))));
+      const int framesPerRow = std::max(1, numFrames / numRows);
+      const int row = frame / framesPerRow;
+      const int col = frame % framesPerRow;
+
+      x = WINDOW_SIZE * (col + 0.5f) / framesPerRow;
+      y = WINDOW_SIZE * (row + 0.5f) / numRows;
+   }
+}
+
+
+// - MakeEvent -----------------------------------------------------------------
+osg::ref_ptr<osgGA::GUIEventAdapter> MakeEvent(
+   osgGA::GUIEventAdapter::EventType type, double time, float x, float y)
+{
+   osg::ref_ptr<osgGA::GUIEventAdapter> ea(new osgGA::GUIEventAdapter());
+   ea->setEventType(type);
+   ea->setTime(time);
+   ea->setInputRange(0.0f, 0.0f, WINDOW_SIZE, WINDOW_SIZE);
+   ea->setMouseYOrientation(osgGA::GUIEventAdapter::Y_INCREASING_UPWARDS);
+   ea->setX(x);
+   ea->setY(y);
+   ea->setButton(osgGA::GUIEventAdapter::LEFT_MOUSE_BUTTON);
+
+   return ea;
+}
+
+
+// - Percentile ----------------------------------------------------------------
+double Percentile(const std::vector<double>& sorted, double percentile)
+{
+   if (sorted.empty())
+      return 0.0;
+
+   const std::size_t index = std::min(
+      sorted.size() - 1,
+      static_cast<std::size_t>(percentile / 100.0 * sorted.size()));
+
+   return sorted[index];
+}
+
+
+// - ParseOptions --------------------------------------------------------------
+bool ParseOptions(int argc, char* argv[], Options& options)
+{
+   for (int i = 1; i < argc; ++i)
+   {
+      const std::string arg = argv[i];
+
+      if (arg == "--help" || i + 1 >= argc)
+         return false;
+
+      const char* value = argv[++i];
+
+      if (arg == "--nodes")
+         options.numNodes = std::atoi(value);
+      else if (arg == "--depth")
+         options.depth = std::atoi(value);
+      else if (arg == "--triangles")
+         options.trianglesPerNode = std::atoi(value);
+      else if (arg == "--masks")
+         options.numMasks = std::atoi(value);
+      else if (arg == "--frames")
+         options.numFrames = std::atoi(value);
+      else if (arg == "--picker-radius")
+         options.pickerRadius = std::atof(value);
+      else if (arg == "--path")
+         options.path = value;
+      else if (arg == "--json")
+         options.jsonFile = value;
+      else if (arg == "--warmup")
+         options.warmupFrames = std::atoi(value);
+      else if (arg == "--max-nodes-visited")
+         options.maxNodesVisited = std::atol(value);
+      else if (arg == "--max-allocations")
+         options.maxAllocations = std::atol(value);
+      else if (arg == "--max-lookups")
+         options.maxLookups = std::atol(value);
+      else
+         return false;
+   }
+
+   return options.numNodes > 0 && options.depth >= 2
+      && options.trianglesPerNode > 0 && options.numMasks > 0
+      && options.numMasks <= 32 && options.numFrames > 0
+      && options.pickerRadius >= 0.0 && options.warmupFrames >= 0
+      && (options.path == "sweep" || options.path == "circle"
+          || options.path == "random");
+}
+
+
+// - main ----------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+   Options options;
+   if (!ParseOptions(argc, argv, options))
+   {
+      std::cerr
+         << "Usage: " << argv[0] << " [options]\n"
+         << "   --nodes N          Number of registered nodes (1000)\n"
+         << "   --depth N          Depth of each registered node (4)\n"
+         << "   --triangles N      Triangles per node (32)\n"
+         << "   --masks N          Number of picking masks (1)\n"
+         << "   --frames N         Number of frames to run (10000)\n"
+         << "   --picker-radius R  Picker radius (0, a line segment)\n"
+         << "   --path P           Cursor path: sweep, circle, random\n"
+         << "   --json FILE        Write the results to FILE (stdout)\n"
+         << "Budgets (checked after warm-up; exit with failure if exceeded):\n"
+         << "   --warmup N             Frames not checked (100)\n"
+         << "   --max-nodes-visited N  Nodes visited when picking, per frame\n"
+         << "   --max-allocations N    Allocations in the frame path\n"
+         << "   --max-lookups N        Node lookups when picking, per frame\n";
+      return EXIT_FAILURE;
+   }
+
+   // Create the event handler and the scene
+   osg::ref_ptr<OSGUIsh::EventHandler> eh(
+      new OSGUIsh::EventHandler(options.pickerRadius));
+
+   eh->getGlobalSignal(OSGUIsh::EVENT_MOUSE_ENTER)->connect(&HandleMouseEnter);
+   eh->getGlobalSignal(OSGUIsh::EVENT_MOUSE_MOVE)->connect(&HandleMouseMove);
+   eh->getGlobalSignal(OSGUIsh::EVENT_CLICK)->connect(&HandleClick);
+   eh->setCollectPickingStats();
+
+   OSGUIsh::EventHandler::NodeMasks_t masks;
+   for (int i = 0; i < options.numMasks; ++i)
+      masks.push_back(1u << i);
+   eh->setPickingMasks(masks);
+
+   float sceneSize;
+   osg::ref_ptr<osg::Group> scene = CreateScene(options, *eh, sceneSize);
+
+   osg::ref_ptr<HeadlessView> view(new HeadlessView());
+   view->getCamera()->addChild(scene);
+   view->getCamera()->setProjectionMatrixAsOrtho(
+      0.0, sceneSize, 0.0, sceneSize, -1.0, 1.0);
+   view->getCamera()->setViewMatrix(osg::Matrixd::identity());
+
+   // Run the frames
+   std::vector<double> frameTimes;
+   frameTimes.reserve(options.numFrames);
+
+   std::size_t nodesVisited = 0;
+   std::size_t frameAllocations = 0;
+
+   // The largest per frame counts seen after the warm-up
+   std::size_t worstNodesVisited = 0;
+   std::size_t worstAllocations = 0;
+   std::size_t worstLookups = 0;
+   const double frameInterval = 1.0 / 60.0;
+   osg::Timer* timer = osg::Timer::instance();
+
+   for (int frame = 0; frame < options.numFrames; ++frame)
+   {
+      const double time = frame * frameInterval;
+
+      float x, y;
+      GetCursorPosition(options.path, frame, options.numFrames, x, y);
+
+      eh->handle(*MakeEvent(osgGA::GUIEventAdapter::MOVE, time, x, y),
+                 *view);
+
+      // Click now and then
+      if (frame % 50 == 25)
+      {
+         eh->handle(*MakeEvent(osgGA::GUIEventAdapter::PUSH, time, x, y),
+                    *view);
+         eh->handle(*MakeEvent(osgGA::GUIEventAdapter::RELEASE, time, x, y),
+                    *view);
+      }
+
+      view->getFrameStamp()->setFrameNumber(frame);
+      view->getFrameStamp()->setReferenceTime(time);
+
+      osg::ref_ptr<osgGA::GUIEventAdapter> frameEvent =
+         MakeEvent(osgGA::GUIEventAdapter::FRAME, time, x, y);
+
+      const osg::Timer_t start = timer->tick();
+      eh->handle(*frameEvent, *view);
+      frameTimes.push_back(timer->delta_s(start, timer->tick()));
+
+      const OSGUIsh::PickingStats& stats = eh->getPickingStats();
+      nodesVisited += stats.nodesVisited;
+      frameAllocations += eh->getNumAllocationsInLastHandle();
+
+      if (frame >= options.warmupFrames)
+      {
+         worstNodesVisited = std::max(worstNodesVisited, stats.nodesVisited);
+         worstAllocations = std::max(worstAllocations,
+                                     eh->getNumAllocationsInLastHandle());
+         worstLookups = std::max(worstLookups, stats.observedNodeLookups);
+      }
+   }
+
+   // Check the budgets
+   bool withinBudget = true;
+
+   if (options.maxNodesVisited >= 0
+       && worstNodesVisited > static_cast<std::size_t>(options.maxNodesVisited))
+   {
+      std::cerr << "Budget exceeded: visited " << worstNodesVisited
+                << " nodes in a frame (budget: " << options.maxNodesVisited
+                << ").\n";
+      withinBudget = false;
+   }
+
+   if (options.maxAllocations >= 0
+       && worstAllocations > static_cast<std::size_t>(options.maxAllocations))
+   {
+      std::cerr << "Budget exceeded: " << worstAllocations
+                << " allocations in a frame (budget: "
+                << options.maxAllocations << ").\n";
+      withinBudget = false;
+   }
+
+   if (options.maxLookups >= 0
+       && worstLookups > static_cast<std::size_t>(options.maxLookups))
+   {
+      std::cerr << "Budget exceeded: " << worstLookups
+                << " node lookups in a frame (budget: "
+                << options.maxLookups << ").\n";
+      withinBudget = false;
+   }
+
+   // Report
+   double totalTime = 0.0;
+   for (std::size_t i = 0; i < frameTimes.size(); ++i)
+      totalTime += frameTimes[i];
+
+   std::sort(frameTimes.begin(), frameTimes.end());
+
+   std::ofstream jsonFile;
+   if (!options.jsonFile.empty())
+      jsonFile.open(options.jsonFile.c_str());
+
+   std::ostream& os = options.jsonFile.empty() ? std::cout : jsonFile;
+
+   os << "{\n"
+      << "   \"benchmark\": \"OSGUIshBench\",\n"
+      << "   \"nodes\": " << options.numNodes << ",\n"
+      << "   \"depth\": " << options.depth << ",\n"
+      << "   \"trianglesPerNode\": " << options.trianglesPerNode << ",\n"
+      << "   \"masks\": " << options.numMasks << ",\n"
+      << "   \"pickerRadius\": " << options.pickerRadius << ",\n"
+      << "   \"path\": \"" << options.path << "\",\n"
+      << "   \"frames\": " << options.numFrames << ",\n"
+      << "   \"picksPerSecond\": "
+      << (totalTime > 0.0 ? options.numFrames / totalTime : 0.0) << ",\n"
+      << "   \"frameMeanUs\": "
+      << totalTime / options.numFrames * 1e6 << ",\n"
+      << "   \"frameP50Us\": " << Percentile(frameTimes, 50.0) * 1e6 << ",\n"
+      << "   \"frameP99Us\": " << Percentile(frameTimes, 99.0) * 1e6 << ",\n"
+      << "   \"frameMaxUs\": " << frameTimes.back() * 1e6 << ",\n"
+      << "   \"nodesVisitedPerPick\": "
+      << static_cast<double>(nodesVisited) / options.numFrames << ",\n"
+      << "   \"allocationsPerFrame\": "
+      << static_cast<double>(frameAllocations) / options.numFrames << ",\n"
+      << "   \"worstNodesVisited\": " << worstNodesVisited << ",\n"
+      << "   \"worstAllocations\": " << worstAllocations << ",\n"
+      << "   \"worstLookups\": " << worstLookups << ",\n"
+      << "   \"withinBudget\": " << (withinBudget ? "true" : "false") << ",\n"
+      << "   \"enterEvents\": " << NumEnterEvents << ",\n"
+      << "   \"moveEvents\": " << NumMoveEvents << ",\n"
+      << "   \"clickEvents\": " << NumClickEvents << "\n"
+      << "}\n";
+
+   return os.good() && withinBudget ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,249 @@
+/******************************************************************************\
+* MicroBench.cpp                                                               *
+* Microbenchmarks of the OSGUIsh registration, lookup and dispatch primitives. *
+* Leandro Motta Barros                                                         *
+\******************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/lexical_cast.hpp>
+#include <osg/Geode>
+#include <osg/Group>
+#include <osg/Timer>
+#include <osgGA/GUIEventAdapter>
+#include <OSGUIsh/EventHandler.hpp>
+
+
+//
+// Some globals (globals are not a problem in simple benchmarks ;-))
+//
+
+/// Written by the benchmarks, so that the compiler can't optimize them away.
+volatile std::size_t Sink = 0;
+
+/// Has some result been written already? (For the JSON commas.)
+bool FirstResult = true;
+
+
+// - Report --------------------------------------------------------------------
+void Report(const std::string& name, std::size_t iterations,
+            osg::Timer_t start, osg::Timer_t end)
+{
+   const double nsPerOp =
+      osg::Timer::instance()->delta_s(start, end) * 1e9 / iterations;
+
+   std::cout << (FirstResult ? "" : ",\n")
+             << "      { \"name\": \"" << name << "\", \"iterations\": "
+             << iterations << ", \"nsPerOp\": " << nsPerOp << " }";
+
+   FirstResult = false;
+}
+
+
+// - MakeNodes -----------------------------------------------------------------
+std::vector<osg::ref_ptr<osg::Node> > MakeNodes(std::size_t count)
+{
+   std::vector<osg::ref_ptr<osg::Node> > nodes;
+   nodes.reserve(count);
+
+   for (std::size_t i = 0; i < count; ++i)
+      nodes.push_back(new osg::Group());
+
+   return nodes;
+}
+
+
+// - MakeNodePath --------------------------------------------------------------
+osg::NodePath MakeNodePath(const std::vector<osg::ref_ptr<osg::Node> >& nodes)
+{
+   osg::NodePath path;
+   for (std::size_t i = 0; i < nodes.size(); ++i)
+      path.push_back(nodes[i].get());
+
+   return path;
+}
+
+
+// - BenchAddNode --------------------------------------------------------------
+void BenchAddNode(std::size_t numNodes)
+{
+   const std::vector<osg::ref_ptr<osg::Node> > nodes = MakeNodes(numNodes);
+   osg::ref_ptr<OSGUIsh::EventHandler> eh(new OSGUIsh::EventHandler());
+
+   osg::Timer* timer = osg::Timer::instance();
+   const osg::Timer_t start = timer->tick();
+
+   for (std::size_t i = 0; i < numNodes; ++i)
+      eh->addNode(nodes[i]);
+
+   Report("addNode/" + boost::lexical_cast<std::string>(numNodes), numNodes,
+          start, timer->tick());
+}
+
+
+// - BenchGetSignal ------------------------------------------------------------
+void BenchGetSignal(std::size_t numNodes, std::size_t iterations)
+{
+   const std::vector<osg::ref_ptr<osg::Node> > nodes = MakeNodes(numNodes);
+   osg::ref_ptr<OSGUIsh::EventHandler> eh(new OSGUIsh::EventHandler());
+
+   // Register the nodes and create the signals up front, so that only
+   // lookups are measured
+   for (std::size_t i = 0; i < numNodes; ++i)
+   {
+      eh->addNode(nodes[i]);
+      eh->getSignal(nodes[i], OSGUIsh::EVENT_CLICK);
+   }
+
+   osg::Timer* timer = osg::Timer::instance();
+   const osg::Timer_t start = timer->tick();
+
+   for (std::size_t i = 0; i < iterations; ++i)
+   {
+      OSGUIsh::EventHandler::SignalPtr signal =
+         eh->getSignal(nodes[i % numNodes], OSGUIsh::EVENT_CLICK);
+      Sink = Sink + signal->num_slots();
+   }
+
+   Report("getSignal/" + boost::lexical_cast<std::string>(numNodes),
+          iterations, start, timer->tick());
+}
+
+
+// - BenchGetObservedNode ------------------------------------------------------
+void BenchGetObservedNode(std::size_t depth, std::size_t numRegistered,
+                          std::size_t iterations)
+{
+   const std::vector<osg::ref_ptr<osg::Node> > pathNodes = MakeNodes(depth);
+   const std::vector<osg::ref_ptr<osg::Node> > otherNodes =
+      MakeNodes(numRegistered);
+   osg::ref_ptr<OSGUIsh::EventHandler> eh(new OSGUIsh::EventHandler());
+
+   // Only the root of the path is registered: this is the worst case, which
+   // walks the whole path
+   eh->addNode(pathNodes.front());
+   for (std::size_t i = 0; i < numRegistered; ++i)
+      eh->addNode(otherNodes[i]);
+
+   const osg::NodePath path = MakeNodePath(pathNodes);
+
+   osg::Timer* timer = osg::Timer::instance();
+   const osg::Timer_t start = timer->tick();
+
+   for (std::size_t i = 0; i < iterations; ++i)
+      Sink = Sink + eh->getObservedNode(path).valid();
+
+   Report("getObservedNode/depth:" + boost::lexical_cast<std::string>(depth)
+          + "/registered:" + boost::lexical_cast<std::string>(numRegistered),
+          iterations, start, timer->tick());
+}
+
+
+// - BenchIntersection ---------------------------------------------------------
+void BenchIntersection(std::size_t depth, std::size_t iterations)
+{
+   const std::vector<osg::ref_ptr<osg::Node> > pathNodes = MakeNodes(depth);
+
+   osgUtil::LineSegmentIntersector::Intersection hit;
+   hit.nodePath = MakeNodePath(pathNodes);
+   hit.matrix = new osg::RefMatrix();
+   hit.localIntersectionPoint = osg::Vec3(1.0, 2.0, 3.0);
+   hit.localIntersectionNormal = osg::Vec3(0.0, 0.0, 1.0);
+
+   osg::Timer* timer = osg::Timer::instance();
+
+   osg::Timer_t start = timer->tick();
+   for (std::size_t i = 0; i < iterations; ++i)
+   {
+      const OSGUIsh::Intersection_t intersection(hit);
+      Sink = Sink + intersection.nodePath.size();
+   }
+
+   Report("Intersection_t/depth:" + boost::lexical_cast<std::string>(depth),
+          iterations, start, timer->tick());
+
+   start = timer->tick();
+   for (std::size_t i = 0; i < iterations; ++i)
+   {
+      const OSGUIsh::IntersectionView_t view(hit);
+      Sink = Sink + view.getNodePath().size();
+   }
+
+   Report("IntersectionView_t/depth:"
+          + boost::lexical_cast<std::string>(depth),
+          iterations, start, timer->tick());
+}
+
+
+// - CountingSlot --------------------------------------------------------------
+void CountingSlot(OSGUIsh::HandlerParams&)
+{
+   Sink = Sink + 1;
+}
+
+
+// - BenchSignal ---------------------------------------------------------------
+void BenchSignal(std::size_t numSlots, std::size_t iterations)
+{
+   OSGUIsh::EventHandler::Signal_t signal;
+   for (std::size_t i = 0; i < numSlots; ++i)
+      signal.connect(&CountingSlot);
+
+   osg::ref_ptr<osg::Node> node(new osg::Group());
+   osg::ref_ptr<osgGA::GUIEventAdapter> ea(new osgGA::GUIEventAdapter());
+   const OSGUIsh::IntersectionView_t hit;
+   OSGUIsh::HandlerParams params(node, *ea, hit);
+
+   osg::Timer* timer = osg::Timer::instance();
+   const osg::Timer_t start = timer->tick();
+
+   for (std::size_t i = 0; i < iterations; ++i)
+      signal(params);
+
+   Report("signal/slots:" + boost::lexical_cast<std::string>(numSlots),
+          iterations, start, timer->tick());
+}
+
+
+// - main ----------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+   // Iterations for the cheap benchmarks; can be scaled from the command line
+   std::size_t iterations = 1000000;
+   if (argc > 1)
+      iterations = std::strtoul(argv[1], 0, 10);
+
+   if (iterations == 0)
+   {
+      std::cerr << "Usage: " << argv[0] << " [iterations]\n";
+      return EXIT_FAILURE;
+   }
+
+   std::cout << "{\n"
+             << "   \"benchmark\": \"OSGUIshMicroBench\",\n"
+             << "   \"results\": [\n";
+
+   BenchAddNode(1000);
+   BenchAddNode(100000);
+
+   BenchGetSignal(10, iterations);
+   BenchGetSignal(1000, iterations);
+   BenchGetSignal(100000, iterations);
+
+   BenchGetObservedNode(4, 1000, iterations);
+   BenchGetObservedNode(16, 1000, iterations);
+   BenchGetObservedNode(64, 1000, iterations);
+
+   BenchIntersection(4, iterations);
+   BenchIntersection(16, iterations);
+
+   BenchSignal(0, iterations);
+   BenchSignal(1, iterations);
+   BenchSignal(8, iterations);
+
+   std::cout << "\n   ]\n}\n";
+
+   return Sink > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -13,6 +13,7 @@
 #include <OSGUIsh/EventHandler.hpp>
 #include <OSGUIsh/MouseOverFocusPolicy.hpp>
 #include <OSGUIsh/MouseDownFocusPolicy.hpp>
+#include <OSGUIsh/SpatialFocusPolicy.hpp>
 
 //
 // The available focus policies
@@ -21,7 +22,8 @@ enum FocusPolicy
 {
    ManualFocusPolicy,
    MouseOverFocusPolicy,
-   MouseDownFocusPolicy
+   MouseDownFocusPolicy,
+   SpatialFocusPolicy
 };
 
 
@@ -40,6 +42,8 @@ osg::ref_ptr<osgText::Text> TextKeyboardEvent;
 osg::ref_ptr<osgText::Text> TextKeyboardFocusPolicy;
 osg::ref_ptr<osgText::Text> TextMouseWheelFocusPolicy;
 
+OSGUIsh::ProjectedNodeIndexPtr SpatialIndex;
+
 FocusPolicy KeyboardFocusPolicy = ManualFocusPolicy;
 FocusPolicy MouseWheelFocusPolicy = ManualFocusPolicy;
 
@@ -120,6 +124,7 @@ class ChangePolicyEventHandler: public osgGA::GUIEventHandler
                         "Mouse wheel focus policy: mouse down sets focus");
                      break;
                   case MouseDownFocusPolicy:
+                  case SpatialFocusPolicy:
                      eh_->setMouseWheelFocusPolicy(
                         OSGUIsh::FocusPolicyFactoryMason<
                            OSGUIsh::ManualFocusPolicy>());
@@ -151,6 +156,13 @@ class ChangePolicyEventHandler: public osgGA::GUIEventHandler
                         "Keyboard focus policy: mouse down sets focus");
                      break;
                   case MouseDownFocusPolicy:
+                     eh_->setKeyboardFocusPolicy(
+                        OSGUIsh::SpatialFocusPolicyFactory(SpatialIndex));
+                     KeyboardFocusPolicy = SpatialFocusPolicy;
+                     TextKeyboardFocusPolicy->setText(
+                        "Keyboard focus policy: arrow keys move focus");
+                     break;
+                  case SpatialFocusPolicy:
                      eh_->setKeyboardFocusPolicy(
                         OSGUIsh::FocusPolicyFactoryMason<
                            OSGUIsh::ManualFocusPolicy>());
@@ -314,6 +326,14 @@ int main(int argc, char* argv[])
 
    viewer.addEventHandler(focusPolicyEH);
 
+   // The nodes the spatial focus policy can move the focus to
+   SpatialIndex = OSGUIsh::ProjectedNodeIndexPtr(
+      new OSGUIsh::ProjectedNodeIndex(viewer.getCamera()));
+
+   SpatialIndex->addNode(TreeNode);
+   SpatialIndex->addNode(StrawberryNode);
+   SpatialIndex->addNode(FishNode);
+
    // Adds the node to the event handler, so that it can get events
    guishEH->addNode(TreeNode);
    guishEH->addNode(StrawberryNode);
@@ -25,7 +25,7 @@ osg::ref_ptr<osgText::Text> TextMouseOver;
 
 void HandleMouseEnterOrMove(OSGUIsh::HandlerParams& params)
 {
-   osg::Vec3 wip = params.hit.worldIntersectionPoint;
+   osg::Vec3 wip = params.hit.getWorldIntersectionPoint();
 
    TextMouseOver->setText("Mouse over point( "
                           + boost::lexical_cast<std::string>(wip.x())
@@ -128,6 +128,9 @@ int main(int argc, char* argv[])
    // Create the OSGUIsh event handler
    osg::ref_ptr<OSGUIsh::EventHandler> guishEH(new OSGUIsh::EventHandler(0.01));
 
+   // Lines are thin; don't miss them when moving the mouse quickly
+   guishEH->setSweptPicking(true);
+
    viewer.addEventHandler(guishEH);
 
    // Adds the node to the event handler, so that it can get events
@@ -0,0 +1,312 @@
+/******************************************************************************\
+* Stress.cpp                                                                   *
+* Thousands of observed nodes, with the cost of picking shown on screen.       *
+* Leandro Motta Barros                                                         *
+\******************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <osg/KdTree>
+#include <osg/MatrixTransform>
+#include <osg/PositionAttitudeTransform>
+#include <osgDB/ReadFile>
+#include <osgViewer/Viewer>
+#include <osgViewer/ViewerEventHandlers>
+#include <osgText/Text>
+#include <OSGUIsh/MouseOverFocusPolicy.hpp>
+#include <OSGUIsh/StaticEventHandler.hpp>
+
+//
+// Some globals (globals are not a problem in simple examples ;-))
+//
+
+osg::ref_ptr<OSGUIsh::EventHandler> GuishEH;
+osg::ref_ptr<osgText::Text> TextStats;
+osg::ref_ptr<osgText::Text> TextEvents;
+
+std::size_t NumRegisteredNodes = 0;
+unsigned NumClicks = 0;
+
+/// The picking backends the user can cycle through.
+enum Backend
+{
+   BACKEND_LINE_KDTREE,
+   BACKEND_LINE,
+   BACKEND_POLYTOPE,
+   BACKEND_COUNT
+};
+
+Backend CurrentBackend = BACKEND_LINE_KDTREE;
+
+//
+// The event handlers
+//
+
+void HandleMouseEnter(OSGUIsh::HandlerParams& params)
+{
+   osg::PositionAttitudeTransform* pat =
+      static_cast<osg::PositionAttitudeTransform*>(params.node.get());
+   pat->setScale(osg::Vec3(1.5, 1.5, 1.5));
+   TextEvents->setText("Mouse over " + params.node->getName());
+}
+
+void HandleMouseLeave(OSGUIsh::HandlerParams& params)
+{
+   osg::PositionAttitudeTransform* pat =
+      static_cast<osg::PositionAttitudeTransform*>(params.node.get());
+   pat->setScale(osg::Vec3(1.0, 1.0, 1.0));
+   TextEvents->setText("Mouse over nothing");
+}
+
+void HandleClick(OSGUIsh::HandlerParams& params)
+{
+   std::ostringstream text;
+   text << "Clicked " << params.node->getName() << " (" << ++NumClicks
+        << " clicks so far)";
+   TextEvents->setText(text.str());
+}
+
+void HandleMouseWheel(OSGUIsh::HandlerParams& params)
+{
+   // Called at most once per frame, however fast the wheel events come
+   const double angle = 0.2 * params.wheelDelta.y();
+
+   osg::PositionAttitudeTransform* pat =
+      static_cast<osg::PositionAttitudeTransform*>(params.node.get());
+   pat->setAttitude(
+      pat->getAttitude() * osg::Quat(angle, osg::Vec3(0.0, 0.0, 1.0)));
+}
+
+
+
+// - GetBackendName ------------------------------------------------------------
+const char* GetBackendName(Backend backend)
+{
+   switch (backend)
+   {
+      case BACKEND_LINE_KDTREE: return "line segment, KD-trees";
+      case BACKEND_LINE: return "line segment, no KD-trees";
+      case BACKEND_POLYTOPE: return "polytope";
+      default: return "?";
+   }
+}
+
+
+
+// - SetBackend ----------------------------------------------------------------
+void SetBackend(Backend backend)
+{
+   CurrentBackend = backend;
+   GuishEH->setPickerRadius(backend == BACKEND_POLYTOPE ? 0.005 : 0.0);
+   GuishEH->setUseKdTrees(backend == BACKEND_LINE_KDTREE);
+}
+
+
+
+// - BackendSwitcher -----------------------------------------------------------
+/// Switches to the next picking backend when 'b' is pressed.
+class BackendSwitcher: public osgGA::GUIEventHandler
+{
+   public:
+      bool handle(const osgGA::GUIEventAdapter& ea, osgGA::GUIActionAdapter&)
+      {
+         if (ea.getEventType() != osgGA::GUIEventAdapter::KEYDOWN
+             || ea.getKey() != 'b')
+         {
+            return false;
+         }
+
+         SetBackend(static_cast<Backend>((CurrentBackend + 1) % BACKEND_COUNT));
+         return true;
+      }
+};
+
+
+
+// - StatsUpdater --------------------------------------------------------------
+/// Updates the text with the picking statistics, once per frame.
+class StatsUpdater: public osg::Drawable::UpdateCallback
+{
+   public:
+      void update(osg::NodeVisitor*, osg::Drawable* drawable)
+      {
+         const OSGUIsh::PickingStats& stats = GuishEH->getPickingStats();
+
+         std::ostringstream text;
+         text.setf(std::ios::fixed);
+         text.precision(3);
+         text << "Backend: " << GetBackendName(CurrentBackend)
+              << " ('b' to switch)\n"
+              << "Registered nodes: " << NumRegisteredNodes << '\n'
+              << "Pick: " << (stats.pickEndTime - stats.pickBeginTime) * 1000.0
+              << " ms (" << stats.nodesVisited << " nodes visited)\n"
+              << "Dispatch: " << stats.dispatchTime * 1000.0 << " ms";
+
+         static_cast<osgText::Text*>(drawable)->setText(text.str());
+      }
+};
+
+
+
+// - CreateHUD -----------------------------------------------------------------
+osg::ref_ptr<osg::Projection> CreateHUD(int width, int height)
+{
+   // Create the text nodes to be displayed on the HUD
+   osg::ref_ptr<osg::Geode> hudGeometry(new osg::Geode());
+
+   TextStats = new osgText::Text();
+   TextStats->setDataVariance(osg::Object::DYNAMIC);
+   TextStats->setFont("Data/bluehigl.ttf");
+   TextStats->setPosition(osg::Vec3(10.0f, height - 30.0f, 0.0f));
+   TextStats->setCharacterSize(20.0);
+   TextStats->setUpdateCallback(new StatsUpdater());
+   hudGeometry->addDrawable(TextStats);
+
+   TextEvents = new osgText::Text();
+   TextEvents->setDataVariance(osg::Object::DYNAMIC);
+   TextEvents->setText("Hover, click or use the wheel over the models!");
+   TextEvents->setFont("Data/bluehigl.ttf");
+   TextEvents->setPosition(osg::Vec3(10.0f, 10.0f, 0.0f));
+   TextEvents->setCharacterSize(25.0);
+   hudGeometry->addDrawable(TextEvents);
+
+   // Create the HUD per se
+   osg::ref_ptr<osg::StateSet> stateSet = hudGeometry->getOrCreateStateSet();
+   stateSet->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+   stateSet->setMode(GL_DEPTH_TEST, osg::StateAttribute::OFF);
+   stateSet->setRenderBinDetails(11, "RenderBin");
+
+   osg::ref_ptr<osg::MatrixTransform> modelviewAbs(new osg::MatrixTransform);
+   modelviewAbs->setReferenceFrame(osg::Transform::ABSOLUTE_RF);
+   modelviewAbs->setMatrix(osg::Matrix::identity());
+
+   modelviewAbs->addChild(hudGeometry);
+
+   osg::ref_ptr<osg::Projection> projection(new osg::Projection());
+   projection->setMatrix(osg::Matrix::ortho2D(0, width, 0, height));
+   projection->addChild(modelviewAbs);
+
+   return projection;
+}
+
+
+
+// - LoadModel -----------------------------------------------------------------
+osg::ref_ptr<osg::Node> LoadModel(const std::string& fileName)
+{
+   osg::ref_ptr<osg::Node> loadedModel = osgDB::readNodeFile(fileName);
+
+   if (!loadedModel)
+   {
+      std::cerr << "Problem opening '" << fileName << "'\n";
+      exit(1);
+   }
+
+   // Build the KD-trees once; they are shared by all copies of the model
+   osg::KdTreeBuilder kdTreeBuilder;
+   loadedModel->accept(kdTreeBuilder);
+
+   return loadedModel;
+}
+
+
+
+// - CreateGrid ----------------------------------------------------------------
+/**
+ * Creates a grid with copies of the models, registering every copy with
+ * \c GuishEH. The copies share the models' geometry; only the transforms
+ * above them (which are what gets registered) are unique.
+ */
+osg::ref_ptr<osg::Group> CreateGrid(int columns, int rows)
+{
+   const char* const names[] = { "Tree", "Strawberry", "Fish" };
+   osg::ref_ptr<osg::Node> models[] = {
+      LoadModel("Data/Tree_01.3ds"),
+      LoadModel("Data/Strawberry.3ds"),
+      LoadModel("Data/Fish.3ds") };
+   const int numModels = sizeof(models) / sizeof(models[0]);
+
+   osg::ref_ptr<osg::Group> group(new osg::Group);
+
+   for (int j = 0; j < rows; ++j)
+   {
+      for (int i = 0; i < columns; ++i)
+      {
+         const int model = (i + j) % numModels;
+
+         osg::ref_ptr<osg::PositionAttitudeTransform> pat(
+            new osg::PositionAttitudeTransform());
+
+         std::ostringstream name;
+         name << names[model] << " (" << i << ", " << j << ")";
+         pat->setName(name.str());
+
+         pat->addChild(models[model]);
+         pat->setPosition(
+            osg::Vec3(2.0 * (i - columns / 2), 0.0, 2.0 * (j - rows / 2)));
+         group->addChild(pat);
+
+         GuishEH->addNode(pat);
+
+         GuishEH->getSignal(pat, OSGUIsh::EVENT_MOUSE_ENTER)
+            ->connect(&HandleMouseEnter);
+         GuishEH->getSignal(pat, OSGUIsh::EVENT_MOUSE_LEAVE)
+            ->connect(&HandleMouseLeave);
+         GuishEH->getSignal(pat, OSGUIsh::EVENT_CLICK)
+            ->connect(&HandleClick);
+         GuishEH->getSignal(pat, OSGUIsh::EVENT_MOUSE_WHEEL)
+            ->connect(&HandleMouseWheel);
+
+         ++NumRegisteredNodes;
+      }
+   }
+
+   return group;
+}
+
+
+
+// - main ----------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+   // The grid size can be given in the command line
+   const int columns = argc > 1 ? std::atoi(argv[1]) : 50;
+   const int rows = argc > 2 ? std::atoi(argv[2]) : columns;
+
+   if (columns <= 0 || rows <= 0)
+   {
+      std::cerr << "Usage: " << argv[0] << " [columns [rows]]\n";
+      return 1;
+   }
+
+   // Create a viewer
+   osgViewer::Viewer viewer;
+   viewer.setUpViewInWindow(0, 0, 1024, 768);
+
+   // Create the OSGUIsh event handler, with the wheel following the mouse.
+   // The policies never change here, so they can be fixed at compile time.
+   GuishEH = new OSGUIsh::StaticEventHandler<
+      OSGUIsh::ManualFocusPolicy, OSGUIsh::MouseOverFocusPolicy>();
+
+   GuishEH->setCollectPickingStats();
+   GuishEH->setPickOnButtonEvents();
+   SetBackend(BACKEND_LINE_KDTREE);
+
+   // Construct the scene graph, set it as the data to be viewed
+   osg::ref_ptr<osg::Group> sgRoot = CreateGrid(columns, rows);
+   sgRoot->addChild(CreateHUD(1024, 768));
+   viewer.setSceneData(sgRoot);
+
+   viewer.addEventHandler(GuishEH);
+   viewer.addEventHandler(new BackendSwitcher());
+
+   // Press 's' to see the picking costs along with the rest of the frame
+   osg::ref_ptr<osgViewer::StatsHandler> statsHandler(
+      new osgViewer::StatsHandler());
+   OSGUIsh::AddPickingStatsLines(*statsHandler, viewer);
+   viewer.addEventHandler(statsHandler);
+
+   // Enter rendering loop
+   viewer.run();
+}
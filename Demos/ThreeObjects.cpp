@@ -9,6 +9,7 @@
 #include <osg/PositionAttitudeTransform>
 #include <osgDB/ReadFile>
 #include <osgViewer/Viewer>
+#include <osgViewer/ViewerEventHandlers>
 #include <osgText/Text>
 #include <OSGUIsh/EventHandler.hpp>
 
@@ -156,6 +157,12 @@ int main(int argc, char* argv[])
 
    viewer.addEventHandler(guishEH);
 
+   // Press 's' to see, among other things, how long picking takes
+   osg::ref_ptr<osgViewer::StatsHandler> statsHandler(
+      new osgViewer::StatsHandler());
+   OSGUIsh::AddPickingStatsLines(*statsHandler, viewer);
+   viewer.addEventHandler(statsHandler);
+
    // Adds the node to the event handler, so that it can get events
    guishEH->addNode(TreeNode);
    guishEH->addNode(StrawberryNode);
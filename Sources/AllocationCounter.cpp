@@ -1,33 +1,40 @@
 /******************************************************************************\
-* ManualFocusPolicy.cpp                                                        *
-* A focus policy that doesn't change the focus.                                *
+* AllocationCounter.cpp                                                        *
+* An opt-in counter of heap allocations.                                       *
 *                                                                              *
-* Copyright (C) 2006-2010 by Leandro Motta Barros.                             *
+* Leandro Motta Barros                                                         *
 *                                                                              *
 * This program is distributed under the OpenSceneGraph Public License. You     *
 * should have received a copy of it with the source distribution, in a file    *
 * named 'COPYING.txt'.                                                         *
 \******************************************************************************/
 
-#include <OSGUIsh/ManualFocusPolicy.hpp>
+#include <OSGUIsh/AllocationCounter.hpp>
+#include <OpenThreads/Atomic>
+
+
+namespace
+{
+   /// The number of allocations counted so far.
+   OpenThreads::Atomic AllocationCount;
+
+} // (anonymous) namespace
 
 
 namespace OSGUIsh
 {
-   // - ManualFocusPolicy::ManualFocusPolicy -----------------------------------
-   ManualFocusPolicy::ManualFocusPolicy(NodePtr& focusedNode)
-      : FocusPolicy(focusedNode)
+   // - GetAllocationCount -----------------------------------------------------
+   std::size_t GetAllocationCount()
    {
-      // empty
+      return AllocationCount;
    }
 
 
 
-   // - ManualFocusPolicy::updateFocus -----------------------------------------
-   void ManualFocusPolicy::updateFocus(const osgGA::GUIEventAdapter& ea,
-                                       const NodePtr nodeUnderMouse)
+   // - CountAllocation --------------------------------------------------------
+   void CountAllocation()
    {
-      // Do nothing. That's what "manual" is about.
+      ++AllocationCount;
    }
 
 } // namespace OSGUIsh
@@ -10,7 +10,18 @@
 \******************************************************************************/
 
 #include "OSGUIsh/EventHandler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
+#include <OSGUIsh/AllocationCounter.hpp>
+#include <OSGUIsh/Tracer.hpp>
+#include <osg/Billboard>
+#include <osg/PagedLOD>
+#include <osg/Timer>
+#include <osgUtil/IntersectionVisitor>
+#include <osgUtil/PolytopeIntersector>
+#include <osgViewer/View>
 
 
 namespace
@@ -21,13 +32,15 @@ namespace
     *        point of the ray cast into the scene to do the picking.
     * @param hit The structure describing the intersection.
     */
-   bool IsFrontFacing(const osg::Camera* camera,
-                      const OSGUIsh::Intersection_t& hit)
+   bool IsFrontFacing(
+      const osg::Camera* camera,
+      const osgUtil::LineSegmentIntersector::Intersection& hit)
    {
+      const osg::Vec3 worldNormal = hit.getWorldIntersectNormal();
+
       // If we don't have a reliable normal vector, pretend the face is
-      // front-facing. (This handles the PolytopeIntersector case, which does
-      // not provide normals for the intersections.)
-      if (hit.worldIntersectionNormal == osg::Vec3(0.0, 0.0, 0.0))
+      // front-facing.
+      if (worldNormal == osg::Vec3(0.0, 0.0, 0.0))
          return true;
 
       // Do the real is-front-facing test
@@ -36,10 +49,471 @@ namespace
       osg::Vec3 up;
       camera->getViewMatrixAsLookAt(eye, center, up);
 
-      osg::Vec3 rayDir = hit.worldIntersectionPoint - eye;
+      osg::Vec3 rayDir = hit.getWorldIntersectPoint() - eye;
       rayDir.normalize();
 
-      return rayDir * hit.worldIntersectionNormal < 0.0;
+      return rayDir * worldNormal < 0.0;
+   }
+
+
+   /**
+    * Chooses, among the hits found by a \c LineSegmentIntersector, the one
+    * that counts: the nearest one, or the nearest front-facing one if back
+    * faces are ignored.
+    * @return A pointer to the chosen hit, or \c NULL if none counts.
+    */
+   const osgUtil::LineSegmentIntersector::Intersection* ChooseHit(
+      const osg::Camera* camera,
+      const osgUtil::LineSegmentIntersector::Intersections& hitList,
+      bool ignoreBackFaces)
+   {
+      typedef osgUtil::LineSegmentIntersector::Intersections::const_iterator
+         iter_t;
+
+      if (hitList.empty())
+         return 0;
+
+      if (!ignoreBackFaces || hitList.size() < 2)
+         return &*hitList.begin();
+
+      for (iter_t hit = hitList.begin(); hit != hitList.end(); ++hit)
+      {
+         if (IsFrontFacing(camera, *hit))
+            return &*hit;
+      }
+
+      return 0;
+   }
+
+
+   /**
+    * Moves the side planes of a \c PolytopeIntersector, in place, so that it
+    * picks around a given point. (The planes are in the same order the \c
+    * PolytopeIntersector constructor adds them.)
+    * @param picker The intersector to move.
+    * @param vp The viewport picked in.
+    * @param x The horizontal window coordinate to pick at.
+    * @param y The vertical window coordinate to pick at.
+    * @param radius The picker radius, as a fraction of the viewport width.
+    */
+   void PlacePolytope(osgUtil::PolytopeIntersector& picker,
+                      const osg::Viewport* vp, float x, float y,
+                      double radius)
+   {
+      const float dx = vp->width() * radius;
+      const float dy = (vp->height() / vp->width()) * dx;
+
+      osg::Polytope::PlaneList& planes = picker.getPolytope().getPlaneList();
+      planes[0].set(1.0, 0.0, 0.0, -(x-dx));
+      planes[1].set(-1.0, 0.0, 0.0, x+dx);
+      planes[2].set(0.0, 1.0, 0.0, -(y-dy));
+      planes[3].set(0.0, -1.0, 0.0, y+dy);
+   }
+
+
+   /**
+    * Computes the ray, in the world coordinate system, going through a point
+    * of the window.
+    * @param camera The camera viewing the scene.
+    * @param coords The window coordinates of the point.
+    * @param origin The ray origin (at the near plane) is returned here.
+    * @param direction The ray direction (not normalized) is returned here.
+    */
+   void GetWorldRay(const osg::Camera* camera, const osg::Vec2& coords,
+                    osg::Vec3d& origin, osg::Vec3d& direction)
+   {
+      osg::Matrixd inverseVPW;
+      inverseVPW.invert(camera->getViewMatrix()
+                        * camera->getProjectionMatrix()
+                        * camera->getViewport()->computeWindowMatrix());
+
+      origin = osg::Vec3d(coords.x(), coords.y(), 0.0) * inverseVPW;
+      direction = osg::Vec3d(coords.x(), coords.y(), 1.0) * inverseVPW - origin;
+   }
+
+
+   /**
+    * Converts a normalized mouse position to the window coordinates picked
+    * at, in a given viewport.
+    */
+   osg::Vec2 GetPickCoords(const osg::Viewport* vp, float xNormalized,
+                           float yNormalized)
+   {
+      return osg::Vec2(
+         vp->x() + static_cast<int>(vp->width() * (xNormalized * 0.5f + 0.5f)),
+         vp->y() + static_cast<int>(
+            vp->height() * (yNormalized * 0.5f + 0.5f)));
+   }
+
+
+   /**
+    * Returns a reference to an event that can be safely kept for later use.
+    * Events coming from osgViewer are reference counted, so we can just keep a
+    * reference to them. Anything else (say, an event living in the stack) must
+    * be copied.
+    */
+   osg::ref_ptr<const osgGA::GUIEventAdapter> KeepEvent(
+      const osgGA::GUIEventAdapter& ea)
+   {
+      if (ea.referenceCount() > 0)
+         return &ea;
+      else
+         return new osgGA::GUIEventAdapter(ea);
+   }
+
+
+
+   /**
+    * Normalizes a modifier key mask for key bindings: left and right
+    * modifiers become the same (both bits set), and lock keys are dropped.
+    */
+   unsigned NormalizeModKeyMask(unsigned mask)
+   {
+      typedef osgGA::GUIEventAdapter GEA;
+      const unsigned modifiers[] = {
+         GEA::MODKEY_SHIFT, GEA::MODKEY_CTRL, GEA::MODKEY_ALT,
+         GEA::MODKEY_META, GEA::MODKEY_SUPER, GEA::MODKEY_HYPER };
+
+      unsigned normalized = 0;
+      for (std::size_t i = 0; i < sizeof(modifiers)/sizeof(modifiers[0]); ++i)
+      {
+         if ((mask & modifiers[i]) != 0)
+            normalized |= modifiers[i];
+      }
+
+      return normalized;
+   }
+
+
+
+   /**
+    * Returns the viewer stats for a given view, or \c NULL if there are none
+    * (for example, if \c view is not an \c osgViewer::View).
+    */
+   osg::Stats* GetViewerStats(osg::View* view)
+   {
+      osgViewer::View* viewerView = dynamic_cast<osgViewer::View*>(view);
+      if (viewerView == 0 || viewerView->getViewerBase() == 0)
+         return 0;
+
+      return viewerView->getViewerBase()->getViewerStats();
+   }
+
+
+
+   /**
+    * An \c osgUtil::IntersectionVisitor that counts the nodes it visits (used
+    * for picking statistics) and skips the excluded subtrees. When picking
+    * from a camera with a \c LineSegmentIntersector, it also reuses the
+    * matrices and the clone of the intersector OSG would allocate for the
+    * camera on every pick.
+    */
+   class CountingIntersectionVisitor: public osgUtil::IntersectionVisitor
+   {
+      public:
+         typedef boost::unordered_set<const osg::Node*> NodeSet_t;
+
+         CountingIntersectionVisitor(osgUtil::Intersector* intersector,
+                                     const NodeSet_t& exclusions)
+            : osgUtil::IntersectionVisitor(intersector), numVisited(0),
+              excludedNode(0), exclusions_(exclusions),
+              windowMatrix_(new osg::RefMatrix()),
+              projectionMatrix_(new osg::RefMatrix()),
+              viewMatrix_(new osg::RefMatrix()),
+              modelMatrix_(new osg::RefMatrix())
+         { }
+
+         /**
+          * Makes \c picker the intersector used. Unlike \c setIntersector()
+          * (and \c reset()), reuses the entry of the intersector stack
+          * instead of allocating a new one.
+          */
+         void setPicker(osgUtil::Intersector* picker)
+         {
+            if (_intersectorStack.size() == 1)
+               _intersectorStack.front() = picker;
+            else
+               setIntersector(picker);
+         }
+
+         virtual void apply(osg::Node& node)
+         {
+            if (countAndCheck(node))
+               osgUtil::IntersectionVisitor::apply(node);
+         }
+
+         virtual void apply(osg::Geode& geode)
+         {
+            if (countAndCheck(geode))
+               osgUtil::IntersectionVisitor::apply(geode);
+         }
+
+         virtual void apply(osg::Billboard& billboard)
+         {
+            if (countAndCheck(billboard))
+               osgUtil::IntersectionVisitor::apply(billboard);
+         }
+
+         virtual void apply(osg::Group& group)
+         {
+            if (countAndCheck(group))
+               osgUtil::IntersectionVisitor::apply(group);
+         }
+
+         virtual void apply(osg::LOD& lod)
+         {
+            if (countAndCheck(lod))
+               osgUtil::IntersectionVisitor::apply(lod);
+         }
+
+         virtual void apply(osg::PagedLOD& plod)
+         {
+            if (countAndCheck(plod))
+               osgUtil::IntersectionVisitor::apply(plod);
+         }
+
+         virtual void apply(osg::Transform& transform)
+         {
+            if (countAndCheck(transform))
+               osgUtil::IntersectionVisitor::apply(transform);
+         }
+
+         virtual void apply(osg::Projection& projection)
+         {
+            if (countAndCheck(projection))
+               osgUtil::IntersectionVisitor::apply(projection);
+         }
+
+         virtual void apply(osg::Camera& camera)
+         {
+            if (!countAndCheck(camera))
+               return;
+
+            // Does what the base class does for the camera picked from (the
+            // one at the top of the traversal), with our own matrices and
+            // clone. Anything else is left to the base class.
+            osgUtil::LineSegmentIntersector* picker =
+               dynamic_cast<osgUtil::LineSegmentIntersector*>(
+                  getIntersector());
+
+            if (picker == 0
+                || picker->getCoordinateFrame() != osgUtil::Intersector::WINDOW
+                || getProjectionMatrix() != 0
+                || camera.getViewport() == 0)
+            {
+               osgUtil::IntersectionVisitor::apply(camera);
+               return;
+            }
+
+            windowMatrix_->set(camera.getViewport()->computeWindowMatrix());
+            projectionMatrix_->set(camera.getProjectionMatrix());
+            viewMatrix_->set(camera.getViewMatrix());
+
+            pushWindowMatrix(windowMatrix_.get());
+            pushProjectionMatrix(projectionMatrix_.get());
+            pushViewMatrix(viewMatrix_.get());
+            pushModelMatrix(modelMatrix_.get());
+            _intersectorStack.push_back(cloneOf(*picker));
+
+            traverse(camera);
+
+            pop_clone();
+            popModelMatrix();
+            popViewMatrix();
+            popProjectionMatrix();
+            popWindowMatrix();
+         }
+
+         /// The number of nodes visited so far.
+         std::size_t numVisited;
+
+         /// A subtree skipped in addition to the exclusions (may be NULL).
+         const osg::Node* excludedNode;
+
+      private:
+         /// A \c LineSegmentIntersector and its clone for the camera.
+         typedef std::pair<
+            osg::ref_ptr<osgUtil::LineSegmentIntersector>,
+            osg::ref_ptr<osgUtil::LineSegmentIntersector> > ClonePair_t;
+
+         /**
+          * Returns a clone of \c picker for the matrices on the stacks, like
+          * \c picker.clone() would. The clone is created the first time \c
+          * picker is seen, and just moved to the new segment afterwards.
+          */
+         osgUtil::LineSegmentIntersector* cloneOf(
+            osgUtil::LineSegmentIntersector& picker)
+         {
+            // The model matrix is the identity at the camera
+            const osg::Matrixd inverse = osg::Matrixd::inverse(
+               *getViewMatrix() * *getProjectionMatrix() * *getWindowMatrix());
+
+            std::vector<ClonePair_t>::iterator p = clones_.begin();
+            while (p != clones_.end() && p->first.get() != &picker)
+               ++p;
+
+            if (p == clones_.end())
+            {
+               osg::ref_ptr<osgUtil::Intersector> clone = picker.clone(*this);
+               clones_.push_back(
+                  ClonePair_t(&picker,
+                              static_cast<osgUtil::LineSegmentIntersector*>(
+                                 clone.get())));
+               return clones_.back().second.get();
+            }
+
+            osgUtil::LineSegmentIntersector* clone = p->second.get();
+            clone->reset();
+            clone->setStart(picker.getStart() * inverse);
+            clone->setEnd(picker.getEnd() * inverse);
+            clone->setIntersectionLimit(picker.getIntersectionLimit());
+            return clone;
+         }
+
+         /// Counts a visit; returns \c false if \c node must be skipped.
+         bool countAndCheck(const osg::Node& node)
+         {
+            ++numVisited;
+            return &node != excludedNode
+               && (exclusions_.empty() || exclusions_.count(&node) == 0);
+         }
+
+         /// The roots of the subtrees skipped.
+         const NodeSet_t& exclusions_;
+
+         /**
+          * The matrices pushed for the camera picked from. (The model matrix
+          * is always the identity; hits keep references to it.)
+          */
+         osg::ref_ptr<osg::RefMatrix> windowMatrix_;
+         osg::ref_ptr<osg::RefMatrix> projectionMatrix_;
+         osg::ref_ptr<osg::RefMatrix> viewMatrix_;
+         osg::ref_ptr<osg::RefMatrix> modelMatrix_;
+
+         /// The clones made so far, one per intersector picked with.
+         std::vector<ClonePair_t> clones_;
+   };
+
+
+
+   /**
+    * The function object returned by \c EventHandler::makeAsyncSlot(): when
+    * called, copies the parameters and enqueues the real handler in the \c
+    * WorkerPool. The handler gets the main thread queue of the \c
+    * EventHandler, never the pool itself.
+    */
+   class AsyncSlotLauncher
+   {
+      public:
+         AsyncSlotLauncher(OSGUIsh::WorkerPoolPtr pool,
+                           OSGUIsh::MainThreadQueuePtr queue,
+                           const OSGUIsh::EventHandler::AsyncSlot_t& slot)
+            : pool_(pool), queue_(queue), slot_(slot)
+         { }
+
+         void operator()(OSGUIsh::HandlerParams& params)
+         {
+            boost::shared_ptr<OSGUIsh::AsyncHandlerParams> asyncParams(
+               new OSGUIsh::AsyncHandlerParams(params, queue_));
+
+            // Using the node as key keeps per-node ordering. (Shifting drops
+            // the always-zero bits of an aligned pointer.)
+            const std::size_t key =
+               reinterpret_cast<std::size_t>(params.node.get()) >> 4;
+
+            pool_->enqueue(key, boost::bind(&Run, slot_, asyncParams));
+         }
+
+      private:
+         static void Run(OSGUIsh::EventHandler::AsyncSlot_t slot,
+                         boost::shared_ptr<OSGUIsh::AsyncHandlerParams> params)
+         {
+            slot(*params);
+         }
+
+         OSGUIsh::WorkerPoolPtr pool_;
+         OSGUIsh::MainThreadQueuePtr queue_;
+         OSGUIsh::EventHandler::AsyncSlot_t slot_;
+   };
+
+
+
+   /**
+    * A span of time recorded by a \c Tracer: starts when constructed, and is
+    * added to the trace when destroyed. Does nothing if the \c Tracer is \c
+    * NULL.
+    */
+   class TraceSpan
+   {
+      public:
+         TraceSpan(OSGUIsh::Tracer* tracer, const char* name,
+                   const char* category)
+            : tracer_(tracer), name_(name), category_(category), argName_(0),
+              begin_(tracer != 0 ? OSGUIsh::Tracer::now() : 0.0)
+         { }
+
+         ~TraceSpan()
+         {
+            if (tracer_ != 0)
+            {
+               tracer_->addSpan(name_, category_, begin_,
+                                OSGUIsh::Tracer::now(), argName_, argValue_);
+            }
+         }
+
+         /// Is this span being recorded?
+         bool active() const { return tracer_ != 0; }
+
+         /// Annotates the span with an argument.
+         void setArg(const char* name, const std::string& value)
+         {
+            argName_ = name;
+            argValue_ = value;
+         }
+
+      private:
+         OSGUIsh::Tracer* tracer_;
+         const char* name_;
+         const char* category_;
+         const char* argName_;
+         std::string argValue_;
+         double begin_;
+   };
+
+
+
+   /// Returns the name of an OSG event type, for traces.
+   const char* GetEventTypeName(osgGA::GUIEventAdapter::EventType eventType)
+   {
+      typedef osgGA::GUIEventAdapter GEA;
+
+      switch (eventType)
+      {
+         case GEA::PUSH: return "handle PUSH";
+         case GEA::RELEASE: return "handle RELEASE";
+         case GEA::DOUBLECLICK: return "handle DOUBLECLICK";
+         case GEA::DRAG: return "handle DRAG";
+         case GEA::MOVE: return "handle MOVE";
+         case GEA::KEYDOWN: return "handle KEYDOWN";
+         case GEA::KEYUP: return "handle KEYUP";
+         case GEA::FRAME: return "handle FRAME";
+         case GEA::RESIZE: return "handle RESIZE";
+         case GEA::SCROLL: return "handle SCROLL";
+         default: return "handle";
+      }
+   }
+
+
+
+   /// Returns the name used for a node in traces.
+   std::string GetNodeName(const OSGUIsh::NodePtr& node)
+   {
+      if (!node.valid())
+         return "(no node)";
+      else if (node->getName().empty())
+         return "(unnamed)";
+      else
+         return node->getName();
    }
 
 } // (anonymous) namespace
@@ -47,19 +521,53 @@ namespace
 
 namespace OSGUIsh
 {
+   // - AsyncHandlerParams::AsyncHandlerParams ---------------------------------
+   AsyncHandlerParams::AsyncHandlerParams(const HandlerParams& params,
+                                          MainThreadQueuePtr queue)
+      : node(params.node), event(KeepEvent(params.event)),
+        hit(params.hit.toIntersection()),
+        target(params.target), phase(params.phase),
+        wheelDelta(params.wheelDelta), queue_(queue)
+   {
+      if (params.motion != 0)
+         motion = *params.motion;
+
+      if (params.drag != 0)
+         drag = *params.drag;
+   }
+
+
+
    // - EventHandler::EventHandler ---------------------------------------------
    EventHandler::EventHandler(
       double pickerRadius,
       const FocusPolicyFactory& kbdPolicyFactory,
       const FocusPolicyFactory& wheelPolicyFactory)
       : pickerRadius_(pickerRadius), ignoreBackFaces_(false),
+        pickOnButtonEvents_(false),
+        handleReturnValues_(0), eventConsumed_(false),
+        mouseDownConsumed_(false),
+        eventPropagation_(false), mainThreadQueue_(new MainThreadQueue()),
+        collectPickingStats_(false),
+        collectingPickingStats_(false), deferredDispatch_(false),
+        deferredHead_(0), deferredCount_(0), lastHandleAllocations_(0),
+        maxMotionSamples_(0), sweptPicking_(false), sweepPixelStep_(2.0f),
+        maxSweepSamples_(0), pendingSweepStart_(0), frameSweepStart_(0),
+        eventClockOffset_(0.0), eventClockSynced_(false),
+        pendingMotionTime_(-1.0), frameMotionTime_(-1.0),
         kbdFocusPolicy_(kbdPolicyFactory.create(kbdFocus_)),
-        wheelFocusPolicy_(wheelPolicyFactory.create(wheelFocus_))
+        wheelFocusPolicy_(wheelPolicyFactory.create(wheelFocus_)),
+        wheelNotch_(1.0f), wheelResidual_(0.0f),
+        dragButton_(LEFT_MOUSE_BUTTON), dragMoved_(false),
+        pickWhileDragging_(false)
    {
       assert(pickerRadius_ >= 0.0 && "Cannot use negative picker radius");
 
       addNode(NodePtr());
 
+      for (int i = 0; i < EVENT_COUNT; ++i)
+         globalSignals_[i] = SignalPtr(new Signal_t());
+
       for (int i = 0; i < MOUSE_BUTTON_COUNT; ++i)
       {
          nodeThatGotMouseDown_[i] = NodePtr();
@@ -68,230 +576,1436 @@ namespace OSGUIsh
       }
 
       pickingMasks_.push_back(0xFFFFFFFF); // by default, no restrictions
+
+      // The picking objects; their real parameters are set when picking
+      for (int i = 0; i < 2; ++i)
+      {
+         lineIntersectors_[i] = new osgUtil::LineSegmentIntersector(
+            osgUtil::Intersector::WINDOW, 0.0, 0.0);
+         polytopeIntersectors_[i] = new osgUtil::PolytopeIntersector(
+            osgUtil::Intersector::WINDOW, 0.0, 0.0, 1.0, 1.0);
+      }
+
+      pickVisitor_ = new CountingIntersectionVisitor(0, pickExclusions_);
+      sweepGroup_ = new osgUtil::IntersectorGroup();
+
+      setMaxMotionSamples(128);
    }
 
 
 
-   // - EventHandler::handle ---------------------------------------------------
-   bool EventHandler::handle(const osgGA::GUIEventAdapter& ea,
-                             osgGA::GUIActionAdapter& aa)
-   {
-      switch (ea.getEventType())
-      {
-         case osgGA::GUIEventAdapter::FRAME:
+   // - EventHandler::handle ---------------------------------------------------
+   bool EventHandler::handle(const osgGA::GUIEventAdapter& ea,
+                             osgGA::GUIActionAdapter& aa)
+   {
+      const std::size_t allocationsBefore = GetAllocationCount();
+
+      TraceSpan span(tracer_.get(), GetEventTypeName(ea.getEventType()),
+                     "handle");
+
+      eventConsumed_ = false;
+
+      if (recorder_)
+      {
+         recorder_->record(
+            ea, ea.getEventType() == osgGA::GUIEventAdapter::FRAME
+               ? dynamic_cast<osg::View*>(&aa) : 0);
+      }
+
+      if (latencyMonitor_)
+         updateLatencyClock(ea);
+
+      switch (ea.getEventType())
+      {
+         case osgGA::GUIEventAdapter::FRAME:
+         {
+            osg::View* view = dynamic_cast<osg::View*>(&aa);
+            assert(view != 0 && "Needed an osg::View here.");
+
+            mainThreadQueue_->runTasks();
+
+            osg::Stats* stats = GetViewerStats(view);
+            const bool statsWanted = stats != 0
+               && stats->collectStats(PICKING_STATS_NAME);
+
+            collectingPickingStats_ = collectPickingStats_ || statsWanted;
+
+            // The motion samples of this frame; their storage is reused
+            frameMotion_.swap(pendingMotion_);
+            pendingMotion_.clear();
+            frameSweepStart_ = pendingSweepStart_;
+            pendingSweepStart_ = 0;
+
+            handleFrameEvent(view, ea);
+
+            if (collectingPickingStats_)
+            {
+               if (statsWanted && view->getFrameStamp() != 0)
+               {
+                  pickingStats_.write(
+                     *stats, view->getFrameStamp()->getFrameNumber());
+               }
+
+               lastPickingStats_ = pickingStats_;
+            }
+
+            pickingStats_.reset();
+
+            // Other handlers (manipulators included) need to see every frame
+            eventConsumed_ = false;
+            break;
+         }
+
+         case osgGA::GUIEventAdapter::PUSH:
+         {
+            osg::View* view = dynamic_cast<osg::View*>(&aa);
+
+            // A node being dragged captures the mouse
+            if (pickOnButtonEvents_ && !dragNode_.valid())
+            {
+               if (view != 0)
+                  updateNodeUnderMouse(view, ea);
+
+               // Sweeping goes on from here
+               pendingSweepStart_ = pendingMotion_.size();
+            }
+
+            handlePushEvent(ea);
+
+            if (view != 0 && !dragNode_.valid() && !dragConstraints_.empty())
+               startDrag(view, ea);
+
+            mouseDownConsumed_ = eventConsumed_;
+            break;
+         }
+
+         case osgGA::GUIEventAdapter::MOVE:
+            addMotionSample(ea);
+            break;
+
+         case osgGA::GUIEventAdapter::DRAG:
+            addMotionSample(ea);
+            eventConsumed_ = mouseDownConsumed_ || dragNode_.valid();
+            break;
+
+         case osgGA::GUIEventAdapter::RELEASE:
+         {
+            osg::View* view = dynamic_cast<osg::View*>(&aa);
+
+            if (dragNode_.valid() && getMouseButton(ea) == dragButton_)
+               endDrag(view, ea);
+
+            if (pickOnButtonEvents_ && !dragNode_.valid())
+            {
+               if (view != 0)
+                  updateNodeUnderMouse(view, ea);
+
+               pendingSweepStart_ = pendingMotion_.size();
+            }
+
+            handleReleaseEvent(ea);
+            eventConsumed_ = eventConsumed_ || mouseDownConsumed_;
+            mouseDownConsumed_ = false;
+            break;
+         }
+
+         case osgGA::GUIEventAdapter::KEYDOWN:
+            handleKeyDownEvent(ea);
+            break;
+
+         case osgGA::GUIEventAdapter::KEYUP:
+            handleKeyUpEvent(ea);
+            break;
+
+         case osgGA::GUIEventAdapter::SCROLL:
+            handleScrollEvent(ea);
+            break;
+
+         default:
+            break;
+      }
+
+      {
+         TraceSpan span(tracer_.get(), "updateFocus", "focus");
+         updateFocus(ea, nodeUnderMouse_);
+      }
+
+      lastHandleAllocations_ = GetAllocationCount() - allocationsBefore;
+
+      return eventConsumed_ || (handleReturnValues_ & ea.getEventType()) != 0;
+   }
+
+
+
+   // - EventHandler::setHandleReturnValue -------------------------------------
+   void EventHandler::setHandleReturnValue(
+      osgGA::GUIEventAdapter::EventType eventType, bool value)
+   {
+      if (value)
+         handleReturnValues_ |= eventType;
+      else
+         handleReturnValues_ &= ~static_cast<unsigned>(eventType);
+   }
+
+
+
+   // - EventHandler::setConsumesEvents ----------------------------------------
+   void EventHandler::setConsumesEvents(const NodePtr node, bool consumes)
+   {
+      if (consumes)
+         consumingNodes_.insert(node.get());
+      else
+         consumingNodes_.erase(node.get());
+   }
+
+
+
+   // - EventHandler::setPickingMask -------------------------------------------
+   void EventHandler::setPickingMask(osg::Node::NodeMask newMask)
+   {
+      std::vector<osg::Node::NodeMask> masks;
+      pickingMasks_ = std::vector<osg::Node::NodeMask>();
+      pickingMasks_.push_back(newMask);
+      lastPickKey_.valid = false;
+   }
+
+
+
+   // - EventHandler::setPickingMasks ------------------------------------------
+   void EventHandler::setPickingMasks(osg::Node::NodeMask newMask1,
+                                      osg::Node::NodeMask newMask2)
+   {
+      std::vector<osg::Node::NodeMask> masks;
+      pickingMasks_ = std::vector<osg::Node::NodeMask>();
+      pickingMasks_.push_back(newMask1);
+      pickingMasks_.push_back(newMask2);
+      lastPickKey_.valid = false;
+   }
+
+
+
+   // - EventHandler::setPickingMasks ------------------------------------------
+   void EventHandler::setPickingMasks(osg::Node::NodeMask newMask1,
+                                      osg::Node::NodeMask newMask2,
+                                      osg::Node::NodeMask newMask3)
+   {
+      std::vector<osg::Node::NodeMask> masks;
+      pickingMasks_ = std::vector<osg::Node::NodeMask>();
+      pickingMasks_.push_back(newMask1);
+      pickingMasks_.push_back(newMask2);
+      pickingMasks_.push_back(newMask3);
+      lastPickKey_.valid = false;
+   }
+
+
+
+   // - EventHandler::setPickingMasks ------------------------------------------
+   void EventHandler::setPickingMasks(
+      const std::vector<osg::Node::NodeMask>& newMasks)
+   {
+      pickingMasks_ = newMasks;
+      lastPickKey_.valid = false;
+   }
+
+
+
+   // - EventHandler::addNode --------------------------------------------------
+   void EventHandler::addNode(const osg::ref_ptr<osg::Node> node)
+   {
+      // Just make sure the node has an entry; signals are created on demand
+      signals_[node];
+   }
+
+
+
+   // - EventHandler::getSignal ------------------------------------------------
+   EventHandler::SignalPtr EventHandler::getSignal(NodePtr node, Event signal)
+   {
+      assert(signal >= 0 && signal < EVENT_COUNT
+             && "Trying to get an unknown signal.");
+
+      SignalsMap_t::iterator signalsCollectionIter = signals_.find(node);
+
+      if (signalsCollectionIter == signals_.end())
+      {
+         throw std::runtime_error(
+            ("Trying to get a signal of an unknown node: '" + node->getName()
+             + "' (" + boost::lexical_cast<std::string>(node) + ").").c_str());
+      }
+
+      SignalPtr& theSignal = signalsCollectionIter->second[signal];
+
+      if (!theSignal)
+         theSignal = SignalPtr(new Signal_t());
+
+      return theSignal;
+   }
+
+
+
+   // - EventHandler::getGlobalSignal ------------------------------------------
+   EventHandler::SignalPtr EventHandler::getGlobalSignal(Event signal)
+   {
+      assert(signal >= 0 && signal < EVENT_COUNT
+             && "Trying to get an unknown signal.");
+
+      return globalSignals_[signal];
+   }
+
+
+
+   // - EventHandler::getCaptureSignal -----------------------------------------
+   EventHandler::SignalPtr EventHandler::getCaptureSignal(NodePtr node,
+                                                          Event signal)
+   {
+      assert(signal >= 0 && signal < EVENT_COUNT
+             && "Trying to get an unknown signal.");
+
+      if (signals_.find(node) == signals_.end())
+      {
+         throw std::runtime_error(
+            ("Trying to get a signal of an unknown node: '" + node->getName()
+             + "' (" + boost::lexical_cast<std::string>(node) + ").").c_str());
+      }
+
+      SignalPtr& theSignal = captureSignals_[node][signal];
+
+      if (!theSignal)
+         theSignal = SignalPtr(new Signal_t());
+
+      return theSignal;
+   }
+
+
+
+   // - EventHandler::getKeySignal ---------------------------------------------
+   EventHandler::SignalPtr EventHandler::getKeySignal(NodePtr node,
+                                                      Event signal, int key,
+                                                      unsigned modKeyMask)
+   {
+      assert((signal == EVENT_KEY_DOWN || signal == EVENT_KEY_UP)
+             && "Key signals exist only for key events.");
+
+      if (signals_.find(node) == signals_.end())
+      {
+         throw std::runtime_error(
+            ("Trying to get a signal of an unknown node: '" + node->getName()
+             + "' (" + boost::lexical_cast<std::string>(node) + ").").c_str());
+      }
+
+      KeyBinding_t binding;
+      binding.node = node.get();
+      binding.event = signal;
+      binding.key = key;
+      binding.modKeyMask = NormalizeModKeyMask(modKeyMask);
+
+      SignalPtr& theSignal = keySignals_[binding];
+
+      if (!theSignal)
+         theSignal = SignalPtr(new Signal_t());
+
+      return theSignal;
+   }
+
+
+
+   // - EventHandler::getGlobalKeySignal ---------------------------------------
+   EventHandler::SignalPtr EventHandler::getGlobalKeySignal(Event signal,
+                                                            int key,
+                                                            unsigned modKeyMask)
+   {
+      assert((signal == EVENT_KEY_DOWN || signal == EVENT_KEY_UP)
+             && "Key signals exist only for key events.");
+
+      KeyBinding_t binding;
+      binding.node = 0;
+      binding.event = signal;
+      binding.key = key;
+      binding.modKeyMask = NormalizeModKeyMask(modKeyMask);
+
+      SignalPtr& theSignal = keySignals_[binding];
+
+      if (!theSignal)
+         theSignal = SignalPtr(new Signal_t());
+
+      return theSignal;
+   }
+
+
+
+   // - EventHandler::makeAsyncSlot --------------------------------------------
+   EventHandler::Slot_t EventHandler::makeAsyncSlot(const AsyncSlot_t& slot)
+   {
+      return AsyncSlotLauncher(getWorkerPool(), mainThreadQueue_, slot);
+   }
+
+
+
+   // - EventHandler::getWorkerPool --------------------------------------------
+   WorkerPoolPtr EventHandler::getWorkerPool()
+   {
+      if (!workerPool_)
+         workerPool_ = WorkerPoolPtr(new WorkerPool());
+
+      return workerPool_;
+   }
+
+
+
+   // - EventHandler::setPickerRadius ------------------------------------------
+   void EventHandler::setPickerRadius(double pickerRadius)
+   {
+      assert(pickerRadius >= 0.0 && "Cannot use negative picker radius");
+      pickerRadius_ = pickerRadius;
+   }
+
+
+
+   // - EventHandler::setMaxMotionSamples --------------------------------------
+   void EventHandler::setMaxMotionSamples(std::size_t maxSamples)
+   {
+      maxMotionSamples_ = maxSamples;
+
+      // Reserve now, so that collecting samples doesn't allocate memory
+      pendingMotion_.reserve(maxSamples);
+      frameMotion_.reserve(maxSamples);
+
+      if (pendingMotion_.size() > maxSamples)
+         pendingMotion_.resize(maxSamples);
+   }
+
+
+
+   // - EventHandler::setSweptPicking ------------------------------------------
+   void EventHandler::setSweptPicking(bool enable, float pixelStep,
+                                      std::size_t maxSamples)
+   {
+      assert(pixelStep > 0.0f && "The sweeping step must be positive");
+
+      sweptPicking_ = enable;
+      sweepPixelStep_ = pixelStep;
+      maxSweepSamples_ = maxSamples;
+
+      if (!enable)
+         return;
+
+      // Create everything now, so that sweeping doesn't allocate memory
+      while (sweepLineIntersectors_.size() < maxSamples)
+      {
+         sweepLineIntersectors_.push_back(
+            new osgUtil::LineSegmentIntersector(
+               osgUtil::Intersector::WINDOW, 0.0, 0.0));
+         sweepPolytopeIntersectors_.push_back(
+            new osgUtil::PolytopeIntersector(
+               osgUtil::Intersector::WINDOW, 0.0, 0.0, 1.0, 1.0));
+      }
+
+      sweepGroup_->getIntersectors().reserve(maxSamples);
+      sweepPath_.reserve(maxMotionSamples_ + 2);
+      sweepNodes_.reserve(maxSamples);
+      sweepHits_.reserve(maxSamples);
+   }
+
+
+
+   // - EventHandler::setDragConstraint ----------------------------------------
+   void EventHandler::setDragConstraint(const NodePtr node,
+                                        const DragConstraint_t& constraint)
+   {
+      assert(signals_.find(node) != signals_.end()
+             && "Only registered nodes can be dragged.");
+
+      dragConstraints_[node] = constraint;
+   }
+
+
+
+   // - EventHandler::removeDragConstraint -------------------------------------
+   void EventHandler::removeDragConstraint(const NodePtr node)
+   {
+      dragConstraints_.erase(node);
+   }
+
+
+
+   // - EventHandler::addPickExclusion -----------------------------------------
+   void EventHandler::addPickExclusion(const NodePtr node)
+   {
+      pickExclusions_.insert(node.get());
+      lastPickKey_.valid = false;
+   }
+
+
+
+   // - EventHandler::removePickExclusion --------------------------------------
+   void EventHandler::removePickExclusion(const NodePtr node)
+   {
+      pickExclusions_.erase(node.get());
+      lastPickKey_.valid = false;
+   }
+
+
+
+   // - EventHandler::clearPickExclusions --------------------------------------
+   void EventHandler::clearPickExclusions()
+   {
+      pickExclusions_.clear();
+      lastPickKey_.valid = false;
+   }
+
+
+
+   // - EventHandler::setWheelNotch --------------------------------------------
+   void EventHandler::setWheelNotch(float notch)
+   {
+      assert(notch > 0.0f && "The wheel notch must be positive");
+      wheelNotch_ = notch;
+      wheelResidual_ = 0.0f;
+   }
+
+
+
+   // - EventHandler::setKeyboardFocus -----------------------------------------
+   void EventHandler::setKeyboardFocus(const NodePtr node)
+   {
+      kbdFocus_ = node;
+   }
+
+
+
+   // - EventHandler::setMouseWheelFocus ---------------------------------------
+   void EventHandler::setMouseWheelFocus(const NodePtr node)
+   {
+      wheelFocus_ = node;
+   }
+
+
+
+   // - EventHandler::setKeyboardFocusPolicy -----------------------------------
+   void EventHandler::setKeyboardFocusPolicy(
+      const FocusPolicyFactory& policyFactory)
+   {
+      kbdFocusPolicy_ = policyFactory.create(kbdFocus_);
+   }
+
+
+
+   // - EventHandler::setMouseWheelFocusPolicy ---------------------------------
+   void EventHandler::setMouseWheelFocusPolicy(
+      const FocusPolicyFactory& policyFactory)
+   {
+      wheelFocusPolicy_ = policyFactory.create(wheelFocus_);
+   }
+
+
+
+   // - EventHandler::updateFocus ----------------------------------------------
+   void EventHandler::updateFocus(const osgGA::GUIEventAdapter& ea,
+                                  const NodePtr& nodeUnderMouse)
+   {
+      kbdFocusPolicy_->updateFocus(ea, nodeUnderMouse);
+      wheelFocusPolicy_->updateFocus(ea, nodeUnderMouse);
+   }
+
+
+
+   // - EventHandler::fireSignal -----------------------------------------------
+   void EventHandler::fireSignal(Event event, HandlerParams& params)
+   {
+      TraceSpan span(tracer_.get(), GetEventName(event), "signal");
+      if (span.active())
+         span.setArg("node", GetNodeName(params.node));
+
+      const osg::Timer_t start = profiler_ ? osg::Timer::instance()->tick() : 0;
+
+      SignalsMap_t::const_iterator signalsCollectionIter =
+         signals_.find(params.node);
+
+      if (signalsCollectionIter != signals_.end())
+      {
+         SignalCollection_t::const_iterator signalIter =
+            signalsCollectionIter->second.find(event);
+
+         if (signalIter != signalsCollectionIter->second.end())
+            signalIter->second->operator()(params);
+      }
+
+      if (params.node.valid())
+         globalSignals_[event]->operator()(params);
+
+      if ((event == EVENT_KEY_DOWN || event == EVENT_KEY_UP)
+          && !keySignals_.empty())
+      {
+         fireKeySignals(event, params);
+      }
+
+      if (profiler_)
+      {
+         profiler_->record(
+            params.node, event,
+            osg::Timer::instance()->delta_s(start,
+                                            osg::Timer::instance()->tick()));
+      }
+
+      updateEventConsumed(params);
+   }
+
+
+
+   // - EventHandler::fireKeySignals -------------------------------------------
+   void EventHandler::fireKeySignals(Event event, HandlerParams& params)
+   {
+      KeyBinding_t binding;
+      binding.node = params.node.get();
+      binding.event = event;
+      binding.key = params.event.getKey();
+      binding.modKeyMask = NormalizeModKeyMask(params.event.getModKeyMask());
+
+      KeySignalsMap_t::const_iterator p;
+
+      if (binding.node != 0)
+      {
+         p = keySignals_.find(binding);
+         if (p != keySignals_.end())
+            p->second->operator()(params);
+      }
+
+      binding.node = 0;
+      p = keySignals_.find(binding);
+      if (p != keySignals_.end())
+         p->second->operator()(params);
+   }
+
+
+
+   // - EventHandler::fireCaptureSignal ----------------------------------------
+   void EventHandler::fireCaptureSignal(Event event, HandlerParams& params)
+   {
+      SignalsMap_t::const_iterator signalsCollectionIter =
+         captureSignals_.find(params.node);
+
+      if (signalsCollectionIter != captureSignals_.end())
+      {
+         SignalCollection_t::const_iterator signalIter =
+            signalsCollectionIter->second.find(event);
+
+         if (signalIter != signalsCollectionIter->second.end())
+         {
+            TraceSpan span(tracer_.get(), GetEventName(event),
+                           "capture signal");
+            if (span.active())
+               span.setArg("node", GetNodeName(params.node));
+
+            const osg::Timer_t start =
+               profiler_ ? osg::Timer::instance()->tick() : 0;
+
+            signalIter->second->operator()(params);
+
+            if (profiler_)
+            {
+               profiler_->record(
+                  params.node, event,
+                  osg::Timer::instance()->delta_s(
+                     start, osg::Timer::instance()->tick()));
+            }
+         }
+      }
+
+      updateEventConsumed(params);
+   }
+
+
+
+   // - EventHandler::setDeferredDispatch --------------------------------------
+   void EventHandler::setDeferredDispatch(bool enable, std::size_t capacity)
+   {
+      deferredDispatch_ = enable;
+
+      if (enable)
+         reserveDeferredEvents(capacity);
+   }
+
+
+
+   // - EventHandler::dispatchDeferredEvents -----------------------------------
+   void EventHandler::dispatchDeferredEvents()
+   {
+      const double startTime =
+         collectingPickingStats_ ? osg::Timer::instance()->time_s() : 0.0;
+
+      while (deferredCount_ > 0)
+      {
+         DeferredEvent_t& queued = deferredEvents_[deferredHead_];
+
+         const IntersectionView_t hit(queued.hit);
+         HandlerParams params(queued.target, *queued.ea, hit);
+         params.motion = queued.hasMotion ? &queued.motion : 0;
+         params.drag = queued.hasDrag ? &queued.drag : 0;
+         params.wheelDelta = queued.wheelDelta;
+         deliverEvent(queued.event, params);
+
+         // Release references early; the slot itself is kept for reuse
+         queued.target = NodePtr();
+         queued.ea = 0;
+
+         deferredHead_ = (deferredHead_ + 1) % deferredEvents_.size();
+         --deferredCount_;
+      }
+
+      if (collectingPickingStats_)
+      {
+         pickingStats_.dispatchTime +=
+            osg::Timer::instance()->time_s() - startTime;
+      }
+   }
+
+
+
+   // - EventHandler::queueDeferredEvent ---------------------------------------
+   void EventHandler::queueDeferredEvent(Event event,
+                                         const HandlerParams& params)
+   {
+      // Merge successive "mouse move" events on the same node
+      if (event == EVENT_MOUSE_MOVE && deferredCount_ > 0)
+      {
+         DeferredEvent_t& last = deferredEvents_[
+            (deferredHead_ + deferredCount_ - 1) % deferredEvents_.size()];
+
+         if (last.event == EVENT_MOUSE_MOVE && last.target == params.target)
+         {
+            params.hit.copyTo(last.hit);
+            last.ea = KeepEvent(params.event);
+
+            // The merged event was generated at an earlier frame, so its
+            // mouse positions come before the new ones
+            if (params.motion != 0)
+            {
+               if (!last.hasMotion)
+                  last.motion.clear();
+
+               last.motion.insert(last.motion.end(),
+                                  params.motion->begin(), params.motion->end());
+               last.hasMotion = true;
+            }
+
+            return;
+         }
+      }
+
+      if (deferredCount_ == deferredEvents_.size())
+         reserveDeferredEvents(std::max<std::size_t>(16, 2 * deferredCount_));
+
+      DeferredEvent_t& slot = deferredEvents_[
+         (deferredHead_ + deferredCount_) % deferredEvents_.size()];
+
+      slot.event = event;
+      slot.target = params.target;
+      params.hit.copyTo(slot.hit); // reuses 'slot.hit.nodePath' capacity
+      slot.ea = KeepEvent(params.event);
+      slot.hasMotion = params.motion != 0;
+      if (slot.hasMotion) // reuses 'slot.motion' capacity
+         slot.motion.assign(params.motion->begin(), params.motion->end());
+
+      slot.hasDrag = params.drag != 0;
+      if (slot.hasDrag)
+         slot.drag = *params.drag;
+
+      slot.wheelDelta = params.wheelDelta;
+
+      ++deferredCount_;
+   }
+
+
+
+   // - EventHandler::reserveDeferredEvents ------------------------------------
+   void EventHandler::reserveDeferredEvents(std::size_t capacity)
+   {
+      if (deferredEvents_.size() >= capacity)
+         return;
+
+      // Unwrap the ring buffer while enlarging it
+      std::vector<DeferredEvent_t> newEvents(capacity);
+      for (std::size_t i = 0; i < deferredCount_; ++i)
+      {
+         newEvents[i] =
+            deferredEvents_[(deferredHead_ + i) % deferredEvents_.size()];
+      }
+
+      deferredEvents_.swap(newEvents);
+      deferredHead_ = 0;
+   }
+
+
+
+   // - EventHandler::dispatchEvent --------------------------------------------
+   void EventHandler::dispatchEvent(Event event, HandlerParams& params)
+   {
+      if (deferredDispatch_)
+      {
+         queueDeferredEvent(event, params);
+
+         // Handlers haven't run yet, but the node can still consume it
+         updateEventConsumed(params);
+      }
+      else if (collectingPickingStats_)
+      {
+         const double startTime = osg::Timer::instance()->time_s();
+         deliverEvent(event, params);
+         pickingStats_.dispatchTime +=
+            osg::Timer::instance()->time_s() - startTime;
+      }
+      else
+      {
+         deliverEvent(event, params);
+      }
+   }
+
+
+
+   // - EventHandler::updateEventConsumed --------------------------------------
+   void EventHandler::updateEventConsumed(const HandlerParams& params)
+   {
+      if (params.isConsumed()
+          || (!consumingNodes_.empty()
+              && consumingNodes_.count(params.node.get()) > 0))
+      {
+         eventConsumed_ = true;
+      }
+   }
+
+
+
+   // - EventHandler::updateLatencyClock ---------------------------------------
+   void EventHandler::updateLatencyClock(const osgGA::GUIEventAdapter& ea)
+   {
+      switch (ea.getEventType())
+      {
+         case osgGA::GUIEventAdapter::FRAME:
+         {
+            // 'FRAME' events are handled right after being created, so they
+            // tell how the event clock relates to 'osg::Timer'. Any delay
+            // only makes the offset larger, hence keeping the smallest one.
+            const double offset =
+               osg::Timer::instance()->time_s() - ea.getTime();
+
+            if (!eventClockSynced_ || offset < eventClockOffset_)
+            {
+               eventClockOffset_ = offset;
+               eventClockSynced_ = true;
+            }
+
+            frameMotionTime_ = pendingMotionTime_;
+            pendingMotionTime_ = -1.0;
+            break;
+         }
+
+         case osgGA::GUIEventAdapter::MOVE:
+         case osgGA::GUIEventAdapter::DRAG:
+            if (pendingMotionTime_ < 0.0)
+               pendingMotionTime_ = ea.getTime();
+            break;
+
+         default:
+            break;
+      }
+   }
+
+
+
+   // - EventHandler::recordLatency --------------------------------------------
+   void EventHandler::recordLatency(Event event, const HandlerParams& params)
+   {
+      double inputTime = params.event.getTime();
+
+      if (event == EVENT_MOUSE_ENTER
+          || event == EVENT_MOUSE_LEAVE
+          || event == EVENT_MOUSE_MOVE
+          || event == EVENT_DRAG)
+      {
+         // Hover and drag events are raised by a 'FRAME'; what matters is
+         // the wait since the mouse moved. If it didn't, the scene moved
+         // instead, and there is no input to measure from.
+         if (frameMotionTime_ < 0.0)
+            return;
+
+         inputTime = frameMotionTime_;
+      }
+
+      const double now = osg::Timer::instance()->time_s() - eventClockOffset_;
+      latencyMonitor_->record(event, std::max(0.0, now - inputTime));
+   }
+
+
+
+   // - EventHandler::deliverEvent ---------------------------------------------
+   void EventHandler::deliverEvent(Event event, HandlerParams& params)
+   {
+      if (latencyMonitor_ && eventClockSynced_)
+         recordLatency(event, params);
+
+      const bool propagates = event == EVENT_MOUSE_MOVE
+         || event == EVENT_MOUSE_DOWN
+         || event == EVENT_MOUSE_UP
+         || event == EVENT_CLICK
+         || event == EVENT_DOUBLE_CLICK;
+
+      if (!eventPropagation_ || !propagates || !params.target.valid())
+      {
+         fireSignal(event, params);
+         return;
+      }
+
+      const osg::NodePath& path = params.hit.getNodePath();
+
+      typedef osg::NodePath::const_iterator iter_t;
+      const iter_t targetIter =
+         std::find(path.begin(), path.end(), params.target.get());
+
+      // Capture phase: from the root down to the target (exclusive)
+      if (targetIter != path.end())
+      {
+         params.phase = PHASE_CAPTURE;
+         for (iter_t p = path.begin(); p != targetIter; ++p)
+         {
+            if (signals_.find(NodePtr(*p)) == signals_.end())
+               continue;
+
+            params.node = *p;
+            fireCaptureSignal(event, params);
+
+            if (params.isPropagationStopped())
+               return;
+         }
+      }
+
+      // Target phase: capture signals first, then the regular ones
+      params.node = params.target;
+      params.phase = PHASE_TARGET;
+
+      fireCaptureSignal(event, params);
+      if (params.isPropagationStopped())
+         return;
+
+      fireSignal(event, params);
+      if (params.isPropagationStopped() || targetIter == path.end())
+         return;
+
+      // Bubble phase: from the target (exclusive) up to the root
+      params.phase = PHASE_BUBBLE;
+      for (iter_t p = targetIter; p != path.begin(); )
+      {
+         --p;
+
+         if (signals_.find(NodePtr(*p)) == signals_.end())
+            continue;
+
+         params.node = *p;
+         fireSignal(event, params);
+
+         if (params.isPropagationStopped())
+            return;
+      }
+   }
+
+
+
+   // - EventHandler::getObservedNode ------------------------------------------
+   NodePtr EventHandler::getObservedNode(const osg::NodePath& nodePath) const
+   {
+      std::size_t numLookups;
+      return findObservedNode(nodePath, numLookups);
+   }
+
+
+
+   // - EventHandler::findObservedNode -----------------------------------------
+   NodePtr EventHandler::findObservedNode(const osg::NodePath& nodePath,
+                                          std::size_t& numLookups) const
+   {
+      numLookups = 0;
+
+      typedef osg::NodePath::const_reverse_iterator iter_t;
+      for (iter_t p = nodePath.rbegin(); p != nodePath.rend(); ++p)
+      {
+         ++numLookups;
+
+         if (signals_.find(NodePtr(*p)) != signals_.end())
+            return *p;
+      }
+
+      return NodePtr();
+   }
+
+
+
+   // - EventHandler::lookupObservedNode ---------------------------------------
+   NodePtr EventHandler::lookupObservedNode(const osg::NodePath& nodePath)
+   {
+      TraceSpan span(tracer_.get(), "getObservedNode", "pick");
+
+      const double startTime =
+         collectingPickingStats_ ? osg::Timer::instance()->time_s() : 0.0;
+
+      std::size_t numLookups;
+      const NodePtr observedNode = findObservedNode(nodePath, numLookups);
+
+      pickingStats_.observedNodeLookups += numLookups;
+
+      if (collectingPickingStats_)
+      {
+         pickingStats_.observedNodeTime +=
+            osg::Timer::instance()->time_s() - startTime;
+      }
+
+      return observedNode;
+   }
+
+
+
+   // - EventHandler::handleFrameEvent -----------------------------------------
+   void EventHandler::handleFrameEvent(osg::View* view,
+                                       const osgGA::GUIEventAdapter& ea)
+   {
+      assert(pickingMasks_.size() > 0);
+
+      if (!pendingWheel_.empty())
+         dispatchWheelEvents();
+
+      const MotionSamples_t* motion = frameMotion_.empty() ? 0 : &frameMotion_;
+
+      // A node being dragged captures the mouse: no need to pick, unless
+      // someone wants to know what is under it
+      if (dragNode_.valid())
+         updateDrag(view, ea, motion);
+
+      if (!dragNode_.valid() || pickWhileDragging_)
+         updateNodeUnderMouse(view, ea, motion);
+   }
+
+
+
+   // - EventHandler::updateNodeUnderMouse -------------------------------------
+   void EventHandler::updateNodeUnderMouse(osg::View* view,
+                                           const osgGA::GUIEventAdapter& ea,
+                                           const MotionSamples_t* motion)
+   {
+      if (sweptPicking_ && motion != 0)
+         sweepPick(view, ea, *motion);
+
+      updatePickingData(view, ea);
+
+      // Trigger the events
+      if (nodeUnderMouse_ == prevNodeUnderMouse_)
+      {
+         if (prevNodeUnderMouse_.valid()
+             && positionUnderMouse_ != prevPositionUnderMouse_)
+         {
+            HandlerParams params (nodeUnderMouse_, ea, hitUnderMouse_);
+            params.motion = motion;
+            dispatchEvent(EVENT_MOUSE_MOVE, params);
+         }
+      }
+      else // nodeUnderMouse != prevNodeUnderMouse_
+      {
+         if (prevNodeUnderMouse_.valid())
+         {
+            HandlerParams params (prevNodeUnderMouse_, ea, hitUnderMouse_);
+            params.motion = motion;
+            dispatchEvent(EVENT_MOUSE_LEAVE, params);
+         }
+
+         if (nodeUnderMouse_.valid())
+         {
+            HandlerParams params (nodeUnderMouse_, ea, hitUnderMouse_);
+            params.motion = motion;
+            dispatchEvent(EVENT_MOUSE_ENTER, params);
+         }
+      }
+   }
+
+
+
+   // - EventHandler::sweepPick ------------------------------------------------
+   void EventHandler::sweepPick(osg::View* view,
+                                const osgGA::GUIEventAdapter& ea,
+                                const MotionSamples_t& motion)
+   {
+      // The path starts where the last pick was done
+      if (!lastPickKey_.valid || lastPickKey_.view != view
+          || maxSweepSamples_ == 0)
+      {
+         return;
+      }
+
+      TraceSpan span(tracer_.get(), "sweep", "pick");
+
+      const osg::Viewport* vp = view->getCamera()->getViewport();
+
+      sweepPath_.clear();
+      sweepPath_.push_back(osg::Vec2(lastPickKey_.x, lastPickKey_.y));
+
+      for (std::size_t i = frameSweepStart_; i < motion.size(); ++i)
+      {
+         sweepPath_.push_back(
+            GetPickCoords(vp, motion[i].xNormalized, motion[i].yNormalized));
+      }
+
+      sweepPath_.push_back(
+         GetPickCoords(vp, ea.getXnormalized(), ea.getYnormalized()));
+
+      float length = 0.0f;
+      for (std::size_t i = 1; i < sweepPath_.size(); ++i)
+         length += (sweepPath_[i] - sweepPath_[i-1]).length();
+
+      // The ends of the path are picked as usual; only the points between
+      // them are picked here, as many as the step asks for (within the cap)
+      if (length <= sweepPixelStep_)
+         return;
+
+      float step = sweepPixelStep_;
+      std::size_t numPoints =
+         static_cast<std::size_t>(std::ceil(length / step)) - 1;
+
+      if (numPoints > maxSweepSamples_)
+      {
+         numPoints = maxSweepSamples_;
+         step = length / (numPoints + 1);
+      }
+
+      const bool usePolytope = pickerRadius_ > 0.0;
+
+      // Place one intersector at each point
+      osgUtil::IntersectorGroup::Intersectors& group =
+         sweepGroup_->getIntersectors();
+      group.clear();
+
+      std::size_t segment = 1;
+      float segmentBegin = 0.0f;
+      float segmentLength = (sweepPath_[1] - sweepPath_[0]).length();
+
+      for (std::size_t i = 0; i < numPoints; ++i)
+      {
+         const float distance = (i + 1) * step;
+
+         while (segmentBegin + segmentLength < distance
+                && segment + 1 < sweepPath_.size())
+         {
+            segmentBegin += segmentLength;
+            ++segment;
+            segmentLength =
+               (sweepPath_[segment] - sweepPath_[segment-1]).length();
+         }
+
+         const float t = segmentLength > 0.0f
+            ? (distance - segmentBegin) / segmentLength
+            : 0.0f;
+
+         const osg::Vec2 point = sweepPath_[segment-1]
+            + (sweepPath_[segment] - sweepPath_[segment-1]) * t;
+
+         if (usePolytope)
          {
-            osg::View* view = dynamic_cast<osg::View*>(&aa);
-            assert(view != 0 && "Needed an osg::View here.");
-            handleFrameEvent(view, ea);
-            break;
+            PlacePolytope(*sweepPolytopeIntersectors_[i], vp, point.x(),
+                          point.y(), pickerRadius_);
+            group.push_back(sweepPolytopeIntersectors_[i]);
          }
+         else
+         {
+            osgUtil::LineSegmentIntersector* picker =
+               sweepLineIntersectors_[i].get();
+            picker->setStart(osg::Vec3d(point.x(), point.y(), 0.0));
+            picker->setEnd(osg::Vec3d(point.x(), point.y(), 1.0));
+            picker->setIntersectionLimit(
+               ignoreBackFaces_
+               ? osgUtil::Intersector::NO_LIMIT
+               : osgUtil::Intersector::LIMIT_NEAREST);
+            group.push_back(picker);
+         }
+      }
 
-         case osgGA::GUIEventAdapter::PUSH:
-            handlePushEvent(ea);
-            break;
-
-         case osgGA::GUIEventAdapter::RELEASE:
-            handleReleaseEvent(ea);
-            break;
+      sweepNodes_.assign(numPoints, NodePtr());
+      sweepHits_.assign(numPoints, IntersectionView_t());
 
-         case osgGA::GUIEventAdapter::KEYDOWN:
-            handleKeyDownEvent(ea);
-            break;
+      // Pick all points in a single traversal per mask. Points resolved with
+      // one mask are left out of the group for the next masks, so that their
+      // hits are kept.
+      CountingIntersectionVisitor& iv =
+         static_cast<CountingIntersectionVisitor&>(*pickVisitor_);
 
-         case osgGA::GUIEventAdapter::KEYUP:
-            handleKeyUpEvent(ea);
-            break;
+      typedef NodeMasks_t::const_iterator iter_t;
+      for (iter_t p = pickingMasks_.begin(); p != pickingMasks_.end(); ++p)
+      {
+         iv.setPicker(sweepGroup_.get());
+         sweepGroup_->reset();
+         iv.setTraversalMask(*p);
+         iv.numVisited = 0;
 
-         case osgGA::GUIEventAdapter::SCROLL:
-            handleScrollEvent(ea);
-            break;
+         view->getCamera()->accept(iv);
 
-         default:
-            break;
-      }
+         ++pickingStats_.masksTried;
+         pickingStats_.nodesVisited += iv.numVisited;
 
-      kbdFocusPolicy_->updateFocus(ea, nodeUnderMouse_);
-      wheelFocusPolicy_->updateFocus(ea, nodeUnderMouse_);
+         group.clear();
 
-      return handleReturnValues_[ea.getEventType()];
-   }
+         for (std::size_t i = 0; i < numPoints; ++i)
+         {
+            if (sweepHits_[i].valid())
+               continue;
 
+            if (usePolytope)
+            {
+               const osgUtil::PolytopeIntersector::Intersections& hitList =
+                  sweepPolytopeIntersectors_[i]->getIntersections();
 
+               pickingStats_.rawHits += hitList.size();
 
-   // - EventHandler::setPickingMask -------------------------------------------
-   void EventHandler::setPickingMask(osg::Node::NodeMask newMask)
-   {
-      std::vector<osg::Node::NodeMask> masks;
-      pickingMasks_ = std::vector<osg::Node::NodeMask>();
-      pickingMasks_.push_back(newMask);
-   }
+               if (!hitList.empty())
+                  sweepHits_[i] = IntersectionView_t(*hitList.begin());
+               else
+                  group.push_back(sweepPolytopeIntersectors_[i]);
+            }
+            else
+            {
+               const osgUtil::LineSegmentIntersector::Intersections& hitList =
+                  sweepLineIntersectors_[i]->getIntersections();
 
+               pickingStats_.rawHits += hitList.size();
 
+               const osgUtil::LineSegmentIntersector::Intersection* theHit =
+                  ChooseHit(view->getCamera(), hitList, ignoreBackFaces_);
 
-   // - EventHandler::setPickingMasks ------------------------------------------
-   void EventHandler::setPickingMasks(osg::Node::NodeMask newMask1,
-                                      osg::Node::NodeMask newMask2)
-   {
-      std::vector<osg::Node::NodeMask> masks;
-      pickingMasks_ = std::vector<osg::Node::NodeMask>();
-      pickingMasks_.push_back(newMask1);
-      pickingMasks_.push_back(newMask2);
-   }
+               if (theHit != 0)
+                  sweepHits_[i] = IntersectionView_t(*theHit);
+               else
+                  group.push_back(sweepLineIntersectors_[i]);
+            }
 
+            if (sweepHits_[i].valid())
+               sweepNodes_[i] = lookupObservedNode(sweepHits_[i].getNodePath());
+         }
 
+         if (group.empty())
+            break;
+      }
 
-   // - EventHandler::setPickingMasks ------------------------------------------
-   void EventHandler::setPickingMasks(osg::Node::NodeMask newMask1,
-                                      osg::Node::NodeMask newMask2,
-                                      osg::Node::NodeMask newMask3)
-   {
-      std::vector<osg::Node::NodeMask> masks;
-      pickingMasks_ = std::vector<osg::Node::NodeMask>();
-      pickingMasks_.push_back(newMask1);
-      pickingMasks_.push_back(newMask2);
-      pickingMasks_.push_back(newMask3);
-   }
+      // Trigger the events for every change along the path
+      NodePtr currentNode = nodeUnderMouse_;
+      osg::Vec3 currentPosition = positionUnderMouse_;
+      bool changed = false;
 
+      for (std::size_t i = 0; i < numPoints; ++i)
+      {
+         if (sweepNodes_[i] == currentNode)
+            continue;
 
+         if (currentNode.valid())
+         {
+            HandlerParams params(currentNode, ea, sweepHits_[i]);
+            params.motion = &motion;
+            dispatchEvent(EVENT_MOUSE_LEAVE, params);
+         }
 
-   // - EventHandler::setPickingMasks ------------------------------------------
-   void EventHandler::setPickingMasks(
-      const std::vector<osg::Node::NodeMask>& newMasks)
-   {
-      pickingMasks_ = newMasks;
-   }
+         currentNode = sweepNodes_[i];
 
+         if (currentNode.valid())
+         {
+            HandlerParams params(currentNode, ea, sweepHits_[i]);
+            params.motion = &motion;
+            dispatchEvent(EVENT_MOUSE_ENTER, params);
+         }
 
+         currentPosition = sweepHits_[i].valid()
+            ? osg::Vec3(sweepHits_[i].getLocalIntersectionPoint())
+            : osg::Vec3();
 
-   // - EventHandler::addNode --------------------------------------------------
-   void EventHandler::addNode(const osg::ref_ptr<osg::Node> node)
-   {
-#     define OSGUISH_EVENTHANDLER_ADD_EVENT(EVENT) \
-         signals_[node][EVENT] = SignalPtr(new EventHandler::Signal_t());
+         changed = true;
+      }
 
-      OSGUISH_EVENTHANDLER_ADD_EVENT(EVENT_MOUSE_ENTER);
-      OSGUISH_EVENTHANDLER_ADD_EVENT(EVENT_MOUSE_LEAVE);
-      OSGUISH_EVENTHANDLER_ADD_EVENT(EVENT_MOUSE_MOVE);
-      OSGUISH_EVENTHANDLER_ADD_EVENT(EVENT_MOUSE_DOWN);
-      OSGUISH_EVENTHANDLER_ADD_EVENT(EVENT_MOUSE_UP);
-      OSGUISH_EVENTHANDLER_ADD_EVENT(EVENT_CLICK);
-      OSGUISH_EVENTHANDLER_ADD_EVENT(EVENT_DOUBLE_CLICK);
-      OSGUISH_EVENTHANDLER_ADD_EVENT(EVENT_MOUSE_WHEEL_UP);
-      OSGUISH_EVENTHANDLER_ADD_EVENT(EVENT_MOUSE_WHEEL_DOWN);
-      OSGUISH_EVENTHANDLER_ADD_EVENT(EVENT_KEY_UP);
-      OSGUISH_EVENTHANDLER_ADD_EVENT(EVENT_KEY_DOWN);
+      sweepNodes_.clear();
 
-#     undef OSGUISH_EVENTHANDLER_ADD_EVENT
+      // The regular pick goes on from the last node crossed
+      if (changed)
+      {
+         nodeUnderMouse_ = currentNode;
+         positionUnderMouse_ = currentPosition;
+         lastPickKey_.valid = false;
+      }
    }
 
 
 
-   // - EventHandler::getSignal ------------------------------------------------
-   EventHandler::SignalPtr EventHandler::getSignal(NodePtr node, Event signal)
+   // - EventHandler::startDrag ------------------------------------------------
+   void EventHandler::startDrag(osg::View* view,
+                                const osgGA::GUIEventAdapter& ea)
    {
-       SignalsMap_t::const_iterator signalsCollectionIter =
-          signals_.find(node);
+      if (!nodeUnderMouse_.valid() || !hitUnderMouse_.valid())
+         return;
 
-      if (signalsCollectionIter == signals_.end())
-      {
-         throw std::runtime_error(
-            ("Trying to get a signal of an unknown node: '" + node->getName()
-             + "' (" + boost::lexical_cast<std::string>(node) + ").").c_str());
-      }
+      const DragConstraints_t::const_iterator p =
+         dragConstraints_.find(nodeUnderMouse_);
 
-      SignalCollection_t::const_iterator signalIter =
-         signalsCollectionIter->second.find(signal);
+      if (p == dragConstraints_.end())
+         return;
 
-      assert(signalIter != signalsCollectionIter->second.end()
-             && "Trying to get an unknown signal.");
+      // Resolve the constraint now; it stays fixed during the drag
+      dragConstraint_ = p->second;
 
-      return signalIter->second;
-   }
+      if (dragConstraint_.kind == DragConstraint_t::VIEW_PLANE)
+      {
+         osg::Vec3d origin;
+         GetWorldRay(view->getCamera(),
+                     GetPickCoords(view->getCamera()->getViewport(),
+                                   ea.getXnormalized(), ea.getYnormalized()),
+                     origin, dragConstraint_.direction);
+         dragConstraint_.kind = DragConstraint_t::PLANE;
+      }
 
+      if (dragConstraint_.direction.normalize() == 0.0)
+         return;
 
+      dragNode_ = nodeUnderMouse_;
+      dragButton_ = getMouseButton(ea);
+      hitUnderMouse_.copyTo(dragHit_);
 
-   // - EventHandler::setKeyboardFocus -----------------------------------------
-   void EventHandler::setKeyboardFocus(const NodePtr node)
-   {
-      kbdFocus_ = node;
-   }
+      dragInfo_.startPoint = hitUnderMouse_.getWorldIntersectionPoint();
+      dragInfo_.point = dragInfo_.startPoint;
+      dragInfo_.previousPoint = dragInfo_.startPoint;
+      dragMoved_ = false;
 
+      // When picking while dragging, the dragged node is out of the way
+      static_cast<CountingIntersectionVisitor&>(*pickVisitor_).excludedNode =
+         dragNode_.get();
+      lastPickKey_.valid = false;
 
+      // Camera manipulators shouldn't start dragging too
+      eventConsumed_ = true;
 
-   // - EventHandler::setMouseWheelFocus ---------------------------------------
-   void EventHandler::setMouseWheelFocus(const NodePtr node)
-   {
-      wheelFocus_ = node;
+      const IntersectionView_t hit(dragHit_);
+      HandlerParams params(dragNode_, ea, hit);
+      params.drag = &dragInfo_;
+      dispatchEvent(EVENT_DRAG_START, params);
    }
 
 
 
-   // - EventHandler::setKeyboardFocusPolicy -----------------------------------
-   void EventHandler::setKeyboardFocusPolicy(
-      const FocusPolicyFactory& policyFactory)
+   // - EventHandler::updateDrag -----------------------------------------------
+   void EventHandler::updateDrag(osg::View* view,
+                                 const osgGA::GUIEventAdapter& ea,
+                                 const MotionSamples_t* motion)
    {
-      kbdFocusPolicy_ = policyFactory.create(kbdFocus_);
+      osg::Vec3d point;
+      if (!projectOnDragConstraint(view, ea, point) || point == dragInfo_.point)
+         return;
+
+      dragInfo_.previousPoint = dragInfo_.point;
+      dragInfo_.point = point;
+      dragMoved_ = true;
+
+      const IntersectionView_t hit(dragHit_);
+      HandlerParams params(dragNode_, ea, hit);
+      params.motion = motion;
+      params.drag = &dragInfo_;
+      dispatchEvent(EVENT_DRAG, params);
    }
 
 
 
-   // - EventHandler::setMouseWheelFocusPolicy ---------------------------------
-   void EventHandler::setMouseWheelFocusPolicy(
-      const FocusPolicyFactory& policyFactory)
+   // - EventHandler::endDrag --------------------------------------------------
+   void EventHandler::endDrag(osg::View* view, const osgGA::GUIEventAdapter& ea)
    {
-      wheelFocusPolicy_ = policyFactory.create(wheelFocus_);
-   }
+      osg::Vec3d point;
+      if (view != 0
+          && projectOnDragConstraint(view, ea, point)
+          && point != dragInfo_.point)
+      {
+         dragInfo_.previousPoint = dragInfo_.point;
+         dragInfo_.point = point;
+         dragMoved_ = true;
+      }
 
+      const IntersectionView_t hit(dragHit_);
+      HandlerParams params(dragNode_, ea, hit);
+      params.drag = &dragInfo_;
+      dispatchEvent(EVENT_DRAG_END, params);
 
+      // Moving something around is not clicking it
+      if (dragMoved_)
+         nodeThatGotMouseDown_[dragButton_] = NodePtr();
 
-   // - EventHandler::getObservedNode ------------------------------------------
-   NodePtr EventHandler::getObservedNode(const osg::NodePath& nodePath)
-   {
-      typedef osg::NodePath::const_reverse_iterator iter_t;
-      for (iter_t p = nodePath.rbegin(); p != nodePath.rend(); ++p)
-      {
-         if (signals_.find(NodePtr(*p)) != signals_.end())
-            return NodePtr(*p);
-      }
+      dragNode_ = NodePtr();
 
-      return NodePtr();
+      static_cast<CountingIntersectionVisitor&>(*pickVisitor_).excludedNode = 0;
+      lastPickKey_.valid = false;
    }
 
 
 
-   // - EventHandler::handleFrameEvent -----------------------------------------
-   void EventHandler::handleFrameEvent(osg::View* view,
-                                       const osgGA::GUIEventAdapter& ea)
+   // - EventHandler::projectOnDragConstraint ----------------------------------
+   bool EventHandler::projectOnDragConstraint(osg::View* view,
+                                              const osgGA::GUIEventAdapter& ea,
+                                              osg::Vec3d& point) const
    {
-      assert(pickingMasks_.size() > 0);
+      osg::Vec3d origin;
+      osg::Vec3d ray;
+      GetWorldRay(view->getCamera(),
+                  GetPickCoords(view->getCamera()->getViewport(),
+                                ea.getXnormalized(), ea.getYnormalized()),
+                  origin, ray);
 
-      updatePickingData(view, ea);
+      const osg::Vec3d& anchor = dragInfo_.startPoint;
+      const osg::Vec3d& dir = dragConstraint_.direction;
 
-      // Trigger the events
-      if (nodeUnderMouse_ == prevNodeUnderMouse_)
+      if (dragConstraint_.kind == DragConstraint_t::AXIS)
       {
-         if (prevNodeUnderMouse_.valid()
-             && positionUnderMouse_ != prevPositionUnderMouse_)
-         {
-            HandlerParams params (nodeUnderMouse_, ea, hitUnderMouse_);
-            signals_[nodeUnderMouse_][EVENT_MOUSE_MOVE]->operator()(params);
-         }
+         // The point of the axis closest to the ray ('dir' is normalized)
+         const osg::Vec3d w = anchor - origin;
+         const double b = dir * ray;
+         const double c = ray * ray;
+         const double denominator = c - b * b;
+
+         if (denominator <= 1e-12 * c)
+            return false; // ray parallel to the axis
+
+         const double s = (b * (ray * w) - c * (dir * w)) / denominator;
+         point = anchor + dir * s;
       }
-      else // nodeUnderMouse != prevNodeUnderMouse_
+      else // PLANE
       {
-         if (prevNodeUnderMouse_.valid())
-         {
-            HandlerParams params (prevNodeUnderMouse_, ea, hitUnderMouse_);
-            signals_[prevNodeUnderMouse_][EVENT_MOUSE_LEAVE]
-               ->operator()(params);
-         }
+         const double dn = dir * ray;
+         if (std::fabs(dn) < 1e-12)
+            return false; // ray parallel to the plane
 
-         if (nodeUnderMouse_.valid())
-         {
-            HandlerParams params (nodeUnderMouse_, ea, hitUnderMouse_);
-            signals_[nodeUnderMouse_][EVENT_MOUSE_ENTER]->operator()(params);
-         }
+         const double t = (dir * (anchor - origin)) / dn;
+         if (t < 0.0)
+            return false; // plane behind the camera
+
+         point = origin + ray * t;
       }
+
+      return true;
+   }
+
+
+
+   // - EventHandler::addMotionSample ------------------------------------------
+   void EventHandler::addMotionSample(const osgGA::GUIEventAdapter& ea)
+   {
+      if (maxMotionSamples_ == 0)
+         return;
+
+      MotionSample_t sample;
+      sample.x = ea.getX();
+      sample.y = ea.getY();
+      sample.xNormalized = ea.getXnormalized();
+      sample.yNormalized = ea.getYnormalized();
+      sample.time = ea.getTime();
+      sample.buttonMask = ea.getButtonMask();
+
+      // When full, keep the latest position (it is the one picked at)
+      if (pendingMotion_.size() < maxMotionSamples_)
+         pendingMotion_.push_back(sample);
+      else
+         pendingMotion_.back() = sample;
    }
 
 
@@ -303,7 +2017,7 @@ namespace OSGUIsh
       if (nodeUnderMouse_.valid())
       {
          HandlerParams params (nodeUnderMouse_, ea, hitUnderMouse_);
-         signals_[nodeUnderMouse_][EVENT_MOUSE_DOWN]->operator()(params);
+         dispatchEvent(EVENT_MOUSE_DOWN, params);
       }
 
       // Do the bookkeeping for "Click" and "DoubleClick"
@@ -324,13 +2038,13 @@ namespace OSGUIsh
 
          // First the trivial case: the "MouseUp" event
          HandlerParams params(nodeUnderMouse_, ea, hitUnderMouse_);
-         signals_[nodeUnderMouse_][EVENT_MOUSE_UP]->operator()(params);
+         dispatchEvent(EVENT_MOUSE_UP, params);
 
          // Now, the trickier ones: "Click" and "DoubleClick"
          if (nodeUnderMouse_ == nodeThatGotMouseDown_[button])
          {
             HandlerParams params(nodeUnderMouse_, ea, hitUnderMouse_);
-            signals_[nodeUnderMouse_][EVENT_CLICK]->operator()(params);
+            dispatchEvent(EVENT_CLICK, params);
 
             const double now = ea.getTime();
 
@@ -338,8 +2052,7 @@ namespace OSGUIsh
                 && nodeUnderMouse_ == nodeThatGotClick_[button])
             {
                HandlerParams params (nodeUnderMouse_, ea, hitUnderMouse_);
-               signals_[nodeUnderMouse_][EVENT_DOUBLE_CLICK]
-                  ->operator()(params);
+               dispatchEvent(EVENT_DOUBLE_CLICK, params);
             }
 
             nodeThatGotClick_[button] = nodeUnderMouse_;
@@ -354,7 +2067,7 @@ namespace OSGUIsh
    void EventHandler::handleKeyDownEvent(const osgGA::GUIEventAdapter& ea)
    {
       HandlerParams params(kbdFocus_, ea, hitUnderMouse_);
-      signals_[kbdFocus_][EVENT_KEY_DOWN]->operator()(params);
+      dispatchEvent(EVENT_KEY_DOWN, params);
    }
 
 
@@ -363,7 +2076,7 @@ namespace OSGUIsh
    void EventHandler::handleKeyUpEvent(const osgGA::GUIEventAdapter& ea)
    {
       HandlerParams params(kbdFocus_, ea, hitUnderMouse_);
-      signals_[kbdFocus_][EVENT_KEY_UP]->operator()(params);
+      dispatchEvent(EVENT_KEY_UP, params);
    }
 
 
@@ -376,14 +2089,55 @@ namespace OSGUIsh
          case osgGA::GUIEventAdapter::SCROLL_UP:
          {
             HandlerParams params(wheelFocus_, ea, hitUnderMouse_);
-            signals_[wheelFocus_][EVENT_MOUSE_WHEEL_UP]->operator()(params);
+            dispatchEvent(EVENT_MOUSE_WHEEL_UP, params);
+            accumulateWheel(ea, osg::Vec2(0.0f, 1.0f));
             break;
          }
 
          case osgGA::GUIEventAdapter::SCROLL_DOWN:
          {
             HandlerParams params(wheelFocus_, ea, hitUnderMouse_);
-            signals_[wheelFocus_][EVENT_MOUSE_WHEEL_DOWN]->operator()(params);
+            dispatchEvent(EVENT_MOUSE_WHEEL_DOWN, params);
+            accumulateWheel(ea, osg::Vec2(0.0f, -1.0f));
+            break;
+         }
+
+         case osgGA::GUIEventAdapter::SCROLL_LEFT:
+            accumulateWheel(ea, osg::Vec2(-1.0f, 0.0f));
+            break;
+
+         case osgGA::GUIEventAdapter::SCROLL_RIGHT:
+            accumulateWheel(ea, osg::Vec2(1.0f, 0.0f));
+            break;
+
+         case osgGA::GUIEventAdapter::SCROLL_2D:
+         {
+            const float dy = ea.getScrollingDeltaY();
+            accumulateWheel(ea, osg::Vec2(ea.getScrollingDeltaX(), dy));
+
+            // Old handlers still want to see wheel notches
+            if (wheelResidualNode_ != wheelFocus_)
+            {
+               wheelResidual_ = 0.0f;
+               wheelResidualNode_ = wheelFocus_;
+            }
+
+            wheelResidual_ += dy;
+
+            while (wheelResidual_ >= wheelNotch_)
+            {
+               wheelResidual_ -= wheelNotch_;
+               HandlerParams params(wheelFocus_, ea, hitUnderMouse_);
+               dispatchEvent(EVENT_MOUSE_WHEEL_UP, params);
+            }
+
+            while (wheelResidual_ <= -wheelNotch_)
+            {
+               wheelResidual_ += wheelNotch_;
+               HandlerParams params(wheelFocus_, ea, hitUnderMouse_);
+               dispatchEvent(EVENT_MOUSE_WHEEL_DOWN, params);
+            }
+
             break;
          }
 
@@ -394,6 +2148,60 @@ namespace OSGUIsh
 
 
 
+   // - EventHandler::accumulateWheel ------------------------------------------
+   void EventHandler::accumulateWheel(const osgGA::GUIEventAdapter& ea,
+                                      const osg::Vec2& delta)
+   {
+      // The "MouseWheel" will come too late to consume this event
+      if (!consumingNodes_.empty()
+          && consumingNodes_.count(wheelFocus_.get()) > 0)
+      {
+         eventConsumed_ = true;
+      }
+
+      typedef std::vector<WheelMotion_t>::iterator iter_t;
+      for (iter_t p = pendingWheel_.begin(); p != pendingWheel_.end(); ++p)
+      {
+         if (p->node == wheelFocus_)
+         {
+            p->delta += delta;
+            p->ea = KeepEvent(ea);
+            return;
+         }
+      }
+
+      // (The vector keeps its capacity from frame to frame.)
+      pendingWheel_.push_back(WheelMotion_t());
+      pendingWheel_.back().node = wheelFocus_;
+      pendingWheel_.back().delta = delta;
+      pendingWheel_.back().ea = KeepEvent(ea);
+   }
+
+
+
+   // - EventHandler::dispatchWheelEvents --------------------------------------
+   void EventHandler::dispatchWheelEvents()
+   {
+      for (std::size_t i = 0; i < pendingWheel_.size(); ++i)
+      {
+         const WheelMotion_t& wheel = pendingWheel_[i];
+
+         // Motions that cancelled out are not worth an event
+         if (wheel.delta == osg::Vec2())
+            continue;
+
+         // The event is the last scroll, so that handlers see its modifier
+         // keys and mouse position (and latencies are measured from it)
+         HandlerParams params(wheel.node, *wheel.ea, hitUnderMouse_);
+         params.wheelDelta = wheel.delta;
+         dispatchEvent(EVENT_MOUSE_WHEEL, params);
+      }
+
+      pendingWheel_.clear();
+   }
+
+
+
    // - EventHandler::getMouseButton -------------------------------------------
    EventHandler::MouseButton EventHandler::getMouseButton(
       const osgGA::GUIEventAdapter& ea)
@@ -423,80 +2231,112 @@ namespace OSGUIsh
    {
       assert(pickerRadius_ >= 0.0 && "Cannot use negative picker radius");
 
+      const osg::Vec2 coords = GetPickCoords(
+         view->getCamera()->getViewport(), ea.getXnormalized(),
+         ea.getYnormalized());
+      const float x = coords.x();
+      const float y = coords.y();
+
+      PickKey_t key;
+      key.valid = view->getFrameStamp() != 0;
+      key.view = view;
+      key.frameNumber = key.valid ? view->getFrameStamp()->getFrameNumber() : 0;
+      key.x = x;
+      key.y = y;
+      key.viewMatrix = view->getCamera()->getViewMatrix();
+      key.projectionMatrix = view->getCamera()->getProjectionMatrix();
+      key.pickerRadius = pickerRadius_;
+      key.ignoreBackFaces = ignoreBackFaces_;
+
+      // Nothing changed since the last pick: the same node is still there
+      if (key == lastPickKey_)
+      {
+         prevNodeUnderMouse_ = nodeUnderMouse_;
+         prevPositionUnderMouse_ = positionUnderMouse_;
+         return;
+      }
+
+      lastPickKey_ = key;
+
+      if (collectingPickingStats_)
+         pickingStats_.pickBeginTime = osg::Timer::instance()->time_s();
+
       if (pickerRadius_ > 0.0)
-         updatePickingDataPolytope(view, ea);
+         updatePickingDataPolytope(view, x, y);
       else
-         updatePickingDataLine(view, ea);
+         updatePickingDataLine(view, x, y);
+
+      if (collectingPickingStats_)
+         pickingStats_.pickEndTime = osg::Timer::instance()->time_s();
    }
 
 
 
    // - EventHandler::updatePickingDataLine ------------------------------------
    void EventHandler::updatePickingDataLine(
-      osg::View* view, const osgGA::GUIEventAdapter& ea)
+      osg::View* view, float x, float y)
    {
-      const osg::Viewport* vp = view->getCamera()->getViewport();
-
-      const float x = vp->x() + static_cast<int>(
-         vp->width() * (ea.getXnormalized() * 0.5f + 0.5f));
-      const float y = vp->y() + static_cast<int>(
-         vp->height() * (ea.getYnormalized() * 0.5f + 0.5f));
-
       NodePtr currentNodeUnderMouse;
       osg::Vec3 currentPositionUnderMouse;
 
+      // Use the intersector 'hitUnderMouse_' doesn't refer to
+      osgUtil::LineSegmentIntersector* picker =
+         lineIntersectors_[0].get() == hitIntersector_.get()
+         ? lineIntersectors_[1].get()
+         : lineIntersectors_[0].get();
+
+      picker->setStart(osg::Vec3d(x, y, 0.0));
+      picker->setEnd(osg::Vec3d(x, y, 1.0));
+
+      // Only the nearest hit is used, unless we have to skip back faces
+      picker->setIntersectionLimit(
+         ignoreBackFaces_
+         ? osgUtil::Intersector::NO_LIMIT
+         : osgUtil::Intersector::LIMIT_NEAREST);
+
+      CountingIntersectionVisitor& iv =
+         static_cast<CountingIntersectionVisitor&>(*pickVisitor_);
+
       typedef NodeMasks_t::const_iterator iter_t;
       for (iter_t p = pickingMasks_.begin(); p != pickingMasks_.end(); ++p)
       {
-         osg::ref_ptr<osgUtil::LineSegmentIntersector> picker(
-            new osgUtil::LineSegmentIntersector(
-               osgUtil::Intersector::WINDOW, x, y));
-
-         osgUtil::IntersectionVisitor iv(picker);
+         iv.setPicker(picker);
+         picker->reset();
          iv.setTraversalMask(*p);
+         iv.numVisited = 0;
 
-         view->getCamera()->accept(iv);
+         {
+            TraceSpan span(tracer_.get(), "pick mask", "pick");
+            if (span.active())
+               span.setArg("mask", boost::lexical_cast<std::string>(*p));
+
+            view->getCamera()->accept(iv);
+         }
+
+         ++pickingStats_.masksTried;
+         pickingStats_.nodesVisited += iv.numVisited;
 
          const osgUtil::LineSegmentIntersector::Intersections& hitList =
             picker->getIntersections();
 
-         if (hitList.size() > 0)
-         {
-            typedef
-               osgUtil::LineSegmentIntersector::Intersections::const_iterator
-               iter_t;
-
-            iter_t theHit = hitList.end();
+         pickingStats_.rawHits += hitList.size();
 
-            if (ignoreBackFaces_ && hitList.size() >= 2)
-            {
-               for (iter_t hit = hitList.begin(); hit != hitList.end(); ++hit)
-               {
-                  if (IsFrontFacing(view->getCamera(), *hit))
-                  {
-                     theHit = hit;
-                     break;
-                  }
-               }
-            }
-            else // !ignoreBackFaces_
-            {
-               theHit = hitList.begin();
-            }
+         const osgUtil::LineSegmentIntersector::Intersection* theHit =
+            ChooseHit(view->getCamera(), hitList, ignoreBackFaces_);
 
-            if (theHit != hitList.end())
-            {
-               currentNodeUnderMouse = getObservedNode(theHit->nodePath);
-               assert(signals_.find(currentNodeUnderMouse) != signals_.end()
-                      && "'getObservedNode()' returned an invalid value!");
+         if (theHit != 0)
+         {
+            currentNodeUnderMouse = lookupObservedNode(theHit->nodePath);
+            assert(signals_.find(currentNodeUnderMouse) != signals_.end()
+                   && "'lookupObservedNode()' returned an invalid value!");
 
-               currentPositionUnderMouse = theHit->getLocalIntersectPoint();
+            currentPositionUnderMouse = theHit->getLocalIntersectPoint();
 
-               hitUnderMouse_ = Intersection_t(*theHit);
+            hitUnderMouse_ = IntersectionView_t(*theHit);
+            hitIntersector_ = picker;
 
-               break;
-            }
-         }  // if (hitList.size() > 0)
+            break;
+         }
       } // for (...pickingMasks_...)
 
       prevNodeUnderMouse_ = nodeUnderMouse_;
@@ -510,35 +2350,47 @@ namespace OSGUIsh
 
    // - EventHandler::updatePickingDataPolytope --------------------------------
    void EventHandler::updatePickingDataPolytope(
-      osg::View* view, const osgGA::GUIEventAdapter& ea)
+      osg::View* view, float x, float y)
    {
-      const osg::Viewport* vp = view->getCamera()->getViewport();
-
-      const float x = vp->x() + static_cast<int>(
-         vp->width() * (ea.getXnormalized() * 0.5f + 0.5f));
-      const float y = vp->y() + static_cast<int>(
-         vp->height() * (ea.getYnormalized() * 0.5f + 0.5f));
-
       NodePtr currentNodeUnderMouse;
       osg::Vec3 currentPositionUnderMouse;
 
+      // Use the intersector 'hitUnderMouse_' doesn't refer to
+      osgUtil::PolytopeIntersector* picker =
+         polytopeIntersectors_[0].get() == hitIntersector_.get()
+         ? polytopeIntersectors_[1].get()
+         : polytopeIntersectors_[0].get();
+
+      PlacePolytope(*picker, view->getCamera()->getViewport(), x, y,
+                    pickerRadius_);
+
+      CountingIntersectionVisitor& iv =
+         static_cast<CountingIntersectionVisitor&>(*pickVisitor_);
+
       typedef NodeMasks_t::const_iterator iter_t;
       for (iter_t p = pickingMasks_.begin(); p != pickingMasks_.end(); ++p)
       {
-         const float dx = vp->width() * pickerRadius_;
-         const float dy = (vp->height() / vp->width()) * dx;
-         osg::ref_ptr<osgUtil::PolytopeIntersector> picker(
-            new osgUtil::PolytopeIntersector(
-               osgUtil::Intersector::WINDOW, x-dx, y-dy, x+dx, y+dy));
-
-         osgUtil::IntersectionVisitor iv(picker);
+         iv.setPicker(picker);
+         picker->reset();
          iv.setTraversalMask(*p);
+         iv.numVisited = 0;
 
-         view->getCamera()->accept(iv);
+         {
+            TraceSpan span(tracer_.get(), "pick mask", "pick");
+            if (span.active())
+               span.setArg("mask", boost::lexical_cast<std::string>(*p));
+
+            view->getCamera()->accept(iv);
+         }
+
+         ++pickingStats_.masksTried;
+         pickingStats_.nodesVisited += iv.numVisited;
 
-         const osgUtil::PolytopeIntersector::Intersections hitList =
+         const osgUtil::PolytopeIntersector::Intersections& hitList =
             picker->getIntersections();
 
+         pickingStats_.rawHits += hitList.size();
+
          if (hitList.size() == 0)
             continue;
 
@@ -547,13 +2399,16 @@ namespace OSGUIsh
 
          iter_t theHit = hitList.begin();
 
-         currentNodeUnderMouse = getObservedNode(theHit->nodePath);
+         currentNodeUnderMouse = lookupObservedNode(theHit->nodePath);
          assert(signals_.find(currentNodeUnderMouse) != signals_.end()
-                && "'getObservedNode()' returned an invalid value!");
+                && "'lookupObservedNode()' returned an invalid value!");
 
          currentPositionUnderMouse = theHit->localIntersectionPoint;
 
-         hitUnderMouse_ = *theHit;
+         hitUnderMouse_ = IntersectionView_t(*theHit);
+         hitIntersector_ = picker;
+
+         break;
       }
 
       prevNodeUnderMouse_ = nodeUnderMouse_;
@@ -0,0 +1,114 @@
+/******************************************************************************\
+* EventRecorder.cpp                                                            *
+* Records the stream of events seen by an EventHandler to a file.              *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#include <OSGUIsh/EventRecorder.hpp>
+#include <osg/Matrixd>
+
+
+namespace OSGUIsh
+{
+   // - EventRecorder::FILE_MAGIC ----------------------------------------------
+   const char EventRecorder::FILE_MAGIC[8] =
+      { 'O', 'S', 'G', 'U', 'I', 's', 'h', 'R' };
+
+
+
+   // - EventRecorder::FILE_VERSION --------------------------------------------
+   const boost::uint32_t EventRecorder::FILE_VERSION;
+
+
+
+   // - EventRecorder::EventRecorder -------------------------------------------
+   EventRecorder::EventRecorder(const std::string& fileName)
+      : file_(fileName.c_str(), std::ios::out | std::ios::binary),
+        numEvents_(0)
+   {
+      const boost::uint32_t byteOrderMark = 0x01020304;
+
+      file_.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+      write(FILE_VERSION);
+      write(byteOrderMark);
+   }
+
+
+
+   // - EventRecorder::record --------------------------------------------------
+   void EventRecorder::record(const osgGA::GUIEventAdapter& ea,
+                              const osg::View* view)
+   {
+      typedef osgGA::GUIEventAdapter GEA;
+
+      // Fields common to all events
+      write(static_cast<boost::uint32_t>(ea.getEventType()));
+      write(ea.getTime());
+      write(ea.getX());
+      write(ea.getY());
+      write(static_cast<boost::uint32_t>(ea.getButtonMask()));
+      write(static_cast<boost::int32_t>(ea.getModKeyMask()));
+
+      // Fields specific to some event types
+      switch (ea.getEventType())
+      {
+         case GEA::PUSH:
+         case GEA::RELEASE:
+         case GEA::DOUBLECLICK:
+            write(static_cast<boost::int32_t>(ea.getButton()));
+            break;
+
+         case GEA::KEYDOWN:
+         case GEA::KEYUP:
+            write(static_cast<boost::int32_t>(ea.getKey()));
+            write(static_cast<boost::int32_t>(ea.getUnmodifiedKey()));
+            break;
+
+         case GEA::SCROLL:
+            write(static_cast<boost::int32_t>(ea.getScrollingMotion()));
+            write(ea.getScrollingDeltaX());
+            write(ea.getScrollingDeltaY());
+            break;
+
+         case GEA::FRAME:
+         {
+            write(ea.getXmin());
+            write(ea.getXmax());
+            write(ea.getYmin());
+            write(ea.getYmax());
+            write(static_cast<boost::int32_t>(ea.getMouseYOrientation()));
+
+            const osg::Camera* camera = view != 0 ? view->getCamera() : 0;
+            const osg::Viewport* vp = camera != 0 ? camera->getViewport() : 0;
+
+            const osg::Matrixd identity;
+            const osg::Matrixd& viewMatrix =
+               camera != 0 ? camera->getViewMatrix() : identity;
+            const osg::Matrixd& projMatrix =
+               camera != 0 ? camera->getProjectionMatrix() : identity;
+
+            file_.write(reinterpret_cast<const char*>(viewMatrix.ptr()),
+                        16 * sizeof(double));
+            file_.write(reinterpret_cast<const char*>(projMatrix.ptr()),
+                        16 * sizeof(double));
+
+            write(vp != 0 ? vp->x() : 0.0);
+            write(vp != 0 ? vp->y() : 0.0);
+            write(vp != 0 ? vp->width() : 0.0);
+            write(vp != 0 ? vp->height() : 0.0);
+            break;
+         }
+
+         default:
+            break;
+      }
+
+      ++numEvents_;
+   }
+
+} // namespace OSGUIsh
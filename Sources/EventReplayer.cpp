@@ -0,0 +1,206 @@
+/******************************************************************************\
+* EventReplayer.cpp                                                            *
+* Feeds events recorded by an EventRecorder back to an event handler.          *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#include <OSGUIsh/EventReplayer.hpp>
+#include <algorithm>
+#include <osg/Camera>
+#include <osg/FrameStamp>
+#include <osg/Viewport>
+#include <OSGUIsh/EventRecorder.hpp>
+
+
+namespace OSGUIsh
+{
+   // - EventReplayer::EventReplayer -------------------------------------------
+   EventReplayer::EventReplayer(const std::string& fileName)
+      : file_(fileName.c_str(), std::ios::in | std::ios::binary),
+        valid_(false), event_(new osgGA::GUIEventAdapter())
+   {
+      std::fill(viewport_, viewport_ + 4, 0.0);
+
+      char magic[sizeof(EventRecorder::FILE_MAGIC)];
+      boost::uint32_t version = 0;
+      boost::uint32_t byteOrderMark = 0;
+
+      file_.read(magic, sizeof(magic));
+      read(version);
+      read(byteOrderMark);
+
+      valid_ = file_.good()
+         && std::equal(magic, magic + sizeof(magic), EventRecorder::FILE_MAGIC)
+         && version == EventRecorder::FILE_VERSION
+         && byteOrderMark == 0x01020304;
+   }
+
+
+
+   // - EventReplayer::readEvent -----------------------------------------------
+   bool EventReplayer::readEvent()
+   {
+      typedef osgGA::GUIEventAdapter GEA;
+
+      if (!valid_)
+         return false;
+
+      // Handlers may keep a reference to the previous event, so create a new
+      // one, starting from the state of the previous one
+      event_ = new osgGA::GUIEventAdapter(*event_);
+
+      boost::uint32_t eventType;
+      double time;
+      float x, y;
+      boost::uint32_t buttonMask;
+      boost::int32_t modKeyMask;
+
+      read(eventType);
+      read(time);
+      read(x);
+      read(y);
+      read(buttonMask);
+      read(modKeyMask);
+
+      event_->setEventType(static_cast<GEA::EventType>(eventType));
+      event_->setTime(time);
+      event_->setX(x);
+      event_->setY(y);
+      event_->setButtonMask(buttonMask);
+      event_->setModKeyMask(modKeyMask);
+
+      switch (eventType)
+      {
+         case GEA::PUSH:
+         case GEA::RELEASE:
+         case GEA::DOUBLECLICK:
+         {
+            boost::int32_t button;
+            read(button);
+            event_->setButton(button);
+            break;
+         }
+
+         case GEA::KEYDOWN:
+         case GEA::KEYUP:
+         {
+            boost::int32_t key;
+            boost::int32_t unmodifiedKey;
+            read(key);
+            read(unmodifiedKey);
+            event_->setKey(key);
+            event_->setUnmodifiedKey(unmodifiedKey);
+            break;
+         }
+
+         case GEA::SCROLL:
+         {
+            boost::int32_t motion;
+            float dx, dy;
+            read(motion);
+            read(dx);
+            read(dy);
+            // (setScrollingMotionDelta() sets the motion to SCROLL_2D, so
+            // it must come first.)
+            event_->setScrollingMotionDelta(dx, dy);
+            event_->setScrollingMotion(
+               static_cast<GEA::ScrollingMotion>(motion));
+            break;
+         }
+
+         case GEA::FRAME:
+         {
+            float xMin, xMax, yMin, yMax;
+            boost::int32_t yOrientation;
+            read(xMin);
+            read(xMax);
+            read(yMin);
+            read(yMax);
+            read(yOrientation);
+            event_->setInputRange(xMin, yMin, xMax, yMax);
+            event_->setMouseYOrientation(
+               static_cast<GEA::MouseYOrientation>(yOrientation));
+
+            double matrix[16];
+            file_.read(reinterpret_cast<char*>(matrix), sizeof(matrix));
+            viewMatrix_.set(matrix);
+            file_.read(reinterpret_cast<char*>(matrix), sizeof(matrix));
+            projectionMatrix_.set(matrix);
+
+            for (int i = 0; i < 4; ++i)
+               read(viewport_[i]);
+            break;
+         }
+
+         default:
+            break;
+      }
+
+      if (!file_.good())
+      {
+         valid_ = false;
+         return false;
+      }
+
+      return true;
+   }
+
+
+
+   // - EventReplayer::applyCameraState ----------------------------------------
+   void EventReplayer::applyCameraState(osg::View& view) const
+   {
+      osg::Camera* camera = view.getCamera();
+
+      camera->setViewMatrix(viewMatrix_);
+      camera->setProjectionMatrix(projectionMatrix_);
+
+      if (camera->getViewport() != 0)
+      {
+         camera->getViewport()->setViewport(
+            viewport_[0], viewport_[1], viewport_[2], viewport_[3]);
+      }
+      else
+      {
+         camera->setViewport(new osg::Viewport(
+            viewport_[0], viewport_[1], viewport_[2], viewport_[3]));
+      }
+   }
+
+
+
+   // - EventReplayer::replay --------------------------------------------------
+   std::size_t EventReplayer::replay(osgGA::GUIEventHandler& handler,
+                                     osg::View& view,
+                                     osgGA::GUIActionAdapter& aa)
+   {
+      std::size_t numEvents = 0;
+
+      while (readEvent())
+      {
+         if (event_->getEventType() == osgGA::GUIEventAdapter::FRAME)
+         {
+            applyCameraState(view);
+
+            osg::FrameStamp* frameStamp = view.getFrameStamp();
+            if (frameStamp != 0)
+            {
+               frameStamp->setFrameNumber(frameStamp->getFrameNumber() + 1);
+               frameStamp->setReferenceTime(event_->getTime());
+               frameStamp->setSimulationTime(event_->getTime());
+            }
+         }
+
+         handler.handle(*event_, aa);
+         ++numEvents;
+      }
+
+      return numEvents;
+   }
+
+} // namespace OSGUIsh
@@ -0,0 +1,170 @@
+/******************************************************************************\
+* HandlerProfiler.cpp                                                          *
+* Measures how long event handlers take to run.                                *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#include <OSGUIsh/HandlerProfiler.hpp>
+#include <fstream>
+#include <osg/Notify>
+
+
+namespace
+{
+   /// Writes a string as a CSV field, quoting it.
+   void WriteCSVString(std::ostream& os, const std::string& str)
+   {
+      os << '"';
+      for (std::string::const_iterator p = str.begin(); p != str.end(); ++p)
+      {
+         if (*p == '"')
+            os << '"';
+         os << *p;
+      }
+      os << '"';
+   }
+
+} // (anonymous) namespace
+
+
+namespace OSGUIsh
+{
+   // - HandlerProfiler::HandlerProfiler ---------------------------------------
+   HandlerProfiler::HandlerProfiler()
+      : slowThreshold_(0.0)
+   {
+      // empty
+   }
+
+
+
+   // - HandlerProfiler::record ------------------------------------------------
+   void HandlerProfiler::record(const NodePtr& node, Event event,
+                                double seconds)
+   {
+      CachedNode_t& cached = nodeCache_[node.get()];
+
+      // A new entry, or one left by a dead node at the same address
+      if (cached.histograms == 0 || cached.node.get() != node.get())
+      {
+         cached.node = node.get();
+         cached.histograms = &histograms_[getNodeName(node)];
+      }
+
+      cached.histograms->byEvent[event].add(seconds);
+
+      if (slowThreshold_ > 0.0 && seconds > slowThreshold_)
+      {
+         if (slowHandlerCallback_)
+         {
+            slowHandlerCallback_(node, event, seconds);
+         }
+         else
+         {
+            osg::notify(osg::WARN)
+               << "OSGUIsh: slow handler for '" << getNodeName(node)
+               << "' (" << GetEventName(event) << "): "
+               << seconds * 1000.0 << " ms\n";
+         }
+      }
+   }
+
+
+
+   // - HandlerProfiler::getHistogram ------------------------------------------
+   const Histogram* HandlerProfiler::getHistogram(const std::string& nodeName,
+                                                  Event event) const
+   {
+      std::map<std::string, NodeHistograms_t>::const_iterator p =
+         histograms_.find(nodeName);
+
+      if (p == histograms_.end() || p->second.byEvent[event].getCount() == 0)
+         return 0;
+
+      return &p->second.byEvent[event];
+   }
+
+
+
+   // - HandlerProfiler::writeCSV ----------------------------------------------
+   void HandlerProfiler::writeCSV(std::ostream& os) const
+   {
+      os << "node,event,count,total_ms,mean_ms,min_ms,p50_ms,p90_ms,p99_ms,"
+         << "max_ms";
+
+      for (std::size_t i = 0; i < Histogram::NUM_BUCKETS; ++i)
+      {
+         os << ",lt_" << Histogram::getBucketUpperBound(i) * 1e6 << "us";
+      }
+
+      os << '\n';
+
+      typedef std::map<std::string, NodeHistograms_t>::const_iterator iter_t;
+      for (iter_t p = histograms_.begin(); p != histograms_.end(); ++p)
+      {
+         for (int e = 0; e < EVENT_COUNT; ++e)
+         {
+            const Histogram& h = p->second.byEvent[e];
+            if (h.getCount() == 0)
+               continue;
+
+            WriteCSVString(os, p->first);
+            os << ',' << GetEventName(static_cast<Event>(e))
+               << ',' << h.getCount()
+               << ',' << h.getTotal() * 1000.0
+               << ',' << h.getMean() * 1000.0
+               << ',' << h.getMin() * 1000.0
+               << ',' << h.getPercentile(50.0) * 1000.0
+               << ',' << h.getPercentile(90.0) * 1000.0
+               << ',' << h.getPercentile(99.0) * 1000.0
+               << ',' << h.getMax() * 1000.0;
+
+            for (std::size_t i = 0; i < Histogram::NUM_BUCKETS; ++i)
+               os << ',' << h.getBucketCount(i);
+
+            os << '\n';
+         }
+      }
+   }
+
+
+
+   // - HandlerProfiler::writeCSV ----------------------------------------------
+   bool HandlerProfiler::writeCSV(const std::string& fileName) const
+   {
+      std::ofstream file(fileName.c_str());
+      if (!file)
+         return false;
+
+      writeCSV(file);
+      return file.good();
+   }
+
+
+
+   // - HandlerProfiler::clear -------------------------------------------------
+   void HandlerProfiler::clear()
+   {
+      nodeCache_.clear();
+      histograms_.clear();
+   }
+
+
+
+   // - HandlerProfiler::getNodeName -------------------------------------------
+   std::string HandlerProfiler::getNodeName(const NodePtr& node)
+   {
+      if (!node.valid())
+         return "(no node)";
+      else if (node->getName().empty())
+         return "(unnamed)";
+      else
+         return node->getName();
+   }
+
+} // namespace OSGUIsh
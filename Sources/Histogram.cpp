@@ -0,0 +1,88 @@
+/******************************************************************************\
+* Histogram.cpp                                                                *
+* A log-bucketed histogram of durations.                                       *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#include <OSGUIsh/Histogram.hpp>
+#include <algorithm>
+#include <cmath>
+
+
+namespace OSGUIsh
+{
+   // - Histogram::Histogram ---------------------------------------------------
+   Histogram::Histogram()
+   {
+      clear();
+   }
+
+
+
+   // - Histogram::add ---------------------------------------------------------
+   void Histogram::add(double seconds)
+   {
+      const double micros = seconds * 1e6;
+
+      std::size_t bucket = 0;
+      if (micros >= 1.0)
+      {
+         int exponent;
+         std::frexp(micros, &exponent); // micros = m * 2^exponent, m in [.5,1)
+         bucket = std::min<std::size_t>(exponent - 1, NUM_BUCKETS - 1);
+      }
+
+      ++buckets_[bucket];
+      ++count_;
+      total_ += seconds;
+      min_ = std::min(min_, seconds);
+      max_ = std::max(max_, seconds);
+   }
+
+
+
+   // - Histogram::clear -------------------------------------------------------
+   void Histogram::clear()
+   {
+      std::fill(buckets_, buckets_ + NUM_BUCKETS, 0);
+      count_ = 0;
+      total_ = 0.0;
+      min_ = HUGE_VAL;
+      max_ = 0.0;
+   }
+
+
+
+   // - Histogram::getPercentile -----------------------------------------------
+   double Histogram::getPercentile(double percentile) const
+   {
+      if (count_ == 0)
+         return 0.0;
+
+      const double wanted = std::max(1.0, count_ * percentile / 100.0);
+
+      std::size_t seen = 0;
+      for (std::size_t i = 0; i < NUM_BUCKETS; ++i)
+      {
+         seen += buckets_[i];
+         if (seen >= wanted)
+            return std::min(getBucketUpperBound(i), max_);
+      }
+
+      return max_;
+   }
+
+
+
+   // - Histogram::getBucketUpperBound -----------------------------------------
+   double Histogram::getBucketUpperBound(std::size_t bucket)
+   {
+      return std::ldexp(1.0, static_cast<int>(bucket) + 1) * 1e-6;
+   }
+
+} // namespace OSGUIsh
@@ -0,0 +1,74 @@
+/******************************************************************************\
+* LatencyMonitor.cpp                                                           *
+* Measures the latency between input events and their handling.               *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#include <OSGUIsh/LatencyMonitor.hpp>
+#include <fstream>
+
+
+namespace OSGUIsh
+{
+   // - LatencyMonitor::writeCSV -----------------------------------------------
+   void LatencyMonitor::writeCSV(std::ostream& os) const
+   {
+      os << "event,count,mean_ms,min_ms,p50_ms,p90_ms,p99_ms,max_ms";
+
+      for (std::size_t i = 0; i < Histogram::NUM_BUCKETS; ++i)
+      {
+         os << ",lt_" << Histogram::getBucketUpperBound(i) * 1e6 << "us";
+      }
+
+      os << '\n';
+
+      for (int e = 0; e < EVENT_COUNT; ++e)
+      {
+         const Histogram& h = histograms_[e];
+         if (h.getCount() == 0)
+            continue;
+
+         os << GetEventName(static_cast<Event>(e))
+            << ',' << h.getCount()
+            << ',' << h.getMean() * 1000.0
+            << ',' << h.getMin() * 1000.0
+            << ',' << h.getPercentile(50.0) * 1000.0
+            << ',' << h.getPercentile(90.0) * 1000.0
+            << ',' << h.getPercentile(99.0) * 1000.0
+            << ',' << h.getMax() * 1000.0;
+
+         for (std::size_t i = 0; i < Histogram::NUM_BUCKETS; ++i)
+            os << ',' << h.getBucketCount(i);
+
+         os << '\n';
+      }
+   }
+
+
+
+   // - LatencyMonitor::writeCSV -----------------------------------------------
+   bool LatencyMonitor::writeCSV(const std::string& fileName) const
+   {
+      std::ofstream file(fileName.c_str());
+      if (!file)
+         return false;
+
+      writeCSV(file);
+      return file.good();
+   }
+
+
+
+   // - LatencyMonitor::clear --------------------------------------------------
+   void LatencyMonitor::clear()
+   {
+      for (int e = 0; e < EVENT_COUNT; ++e)
+         histograms_[e].clear();
+   }
+
+} // namespace OSGUIsh
@@ -0,0 +1,96 @@
+/******************************************************************************\
+* PickingStats.cpp                                                             *
+* Per-frame statistics about the cost of picking and dispatching events.       *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#include <OSGUIsh/PickingStats.hpp>
+#include <osg/Stats>
+#include <osgViewer/ViewerBase>
+#include <osgViewer/ViewerEventHandlers>
+
+
+namespace OSGUIsh
+{
+   // - PICKING_STATS_NAME -----------------------------------------------------
+   const char* const PICKING_STATS_NAME = "osguish";
+
+
+
+   // - PickingStats::reset ----------------------------------------------------
+   void PickingStats::reset()
+   {
+      pickBeginTime = 0.0;
+      pickEndTime = 0.0;
+      masksTried = 0;
+      nodesVisited = 0;
+      rawHits = 0;
+      observedNodeTime = 0.0;
+      observedNodeLookups = 0;
+      dispatchTime = 0.0;
+   }
+
+
+
+   // - PickingStats::write ----------------------------------------------------
+   void PickingStats::write(osg::Stats& stats, unsigned frameNumber) const
+   {
+      stats.setAttribute(frameNumber, "OSGUIsh pick begin time", pickBeginTime);
+      stats.setAttribute(frameNumber, "OSGUIsh pick end time", pickEndTime);
+      stats.setAttribute(frameNumber, "OSGUIsh pick time taken",
+                         pickEndTime - pickBeginTime);
+      stats.setAttribute(frameNumber, "OSGUIsh masks tried", masksTried);
+      stats.setAttribute(frameNumber, "OSGUIsh nodes visited", nodesVisited);
+      stats.setAttribute(frameNumber, "OSGUIsh raw hits", rawHits);
+      stats.setAttribute(frameNumber, "OSGUIsh observed node time taken",
+                         observedNodeTime);
+      stats.setAttribute(frameNumber, "OSGUIsh observed node lookups",
+                         observedNodeLookups);
+      stats.setAttribute(frameNumber, "OSGUIsh dispatch time taken",
+                         dispatchTime);
+   }
+
+
+
+   // - AddPickingStatsLines ---------------------------------------------------
+   void AddPickingStatsLines(osgViewer::StatsHandler& statsHandler,
+                             osgViewer::ViewerBase& viewer)
+   {
+      const osg::Vec4 textColor(1.0f, 1.0f, 0.5f, 1.0f);
+      const osg::Vec4 barColor(1.0f, 1.0f, 0.5f, 0.5f);
+
+      statsHandler.addUserStatsLine(
+         "OSGUIsh pick:", textColor, barColor, "OSGUIsh pick time taken",
+         1000.0, true, false, "OSGUIsh pick begin time",
+         "OSGUIsh pick end time", 10.0);
+
+      statsHandler.addUserStatsLine(
+         "OSGUIsh dispatch:", textColor, barColor,
+         "OSGUIsh dispatch time taken", 1000.0, true, false, "", "", 10.0);
+
+      statsHandler.addUserStatsLine(
+         "OSGUIsh get node:", textColor, barColor,
+         "OSGUIsh observed node time taken", 1000.0, true, false, "", "",
+         10.0);
+
+      statsHandler.addUserStatsLine(
+         "OSGUIsh masks:", textColor, barColor, "OSGUIsh masks tried", 1.0,
+         true, false, "", "", 10.0);
+
+      statsHandler.addUserStatsLine(
+         "OSGUIsh visited:", textColor, barColor, "OSGUIsh nodes visited", 1.0,
+         true, false, "", "", 10000.0);
+
+      statsHandler.addUserStatsLine(
+         "OSGUIsh hits:", textColor, barColor, "OSGUIsh raw hits", 1.0, true,
+         false, "", "", 100.0);
+
+      viewer.getViewerStats()->collectStats(PICKING_STATS_NAME, true);
+   }
+
+} // namespace OSGUIsh
@@ -0,0 +1,435 @@
+/******************************************************************************\
+* ProjectedNodeIndex.cpp                                                       *
+* A 2D index of nodes, by the position of their centers on the screen.         *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#include <OSGUIsh/ProjectedNodeIndex.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <osg/Transform>
+#include <osg/Vec4d>
+
+
+namespace OSGUIsh
+{
+   // - ProjectedNodeIndex::ProjectedNodeIndex ---------------------------------
+   ProjectedNodeIndex::ProjectedNodeIndex(osg::Camera* camera, float cellSize)
+      : camera_(camera), cellSize_(cellSize), front_(&grids_[0]),
+        back_(&grids_[1]), frontValid_(false), building_(false),
+        numProjected_(0)
+   {
+      assert(camera != 0 && "A camera is needed to project nodes");
+      assert(cellSize > 0.0f && "The grid cells must have a positive size");
+   }
+
+
+
+   // - ProjectedNodeIndex::addNode --------------------------------------------
+   void ProjectedNodeIndex::addNode(const NodePtr& node)
+   {
+      if (entryIndices_.find(node.get()) != entryIndices_.end())
+         return;
+
+      const std::size_t i = entries_.size();
+
+      entries_.push_back(Entry_t());
+      entries_.back().node = node;
+      entries_.back().center = computeCenter(*node);
+
+      entryIndices_[node.get()] = i;
+
+      // The grid being built will get to it, as to any other new entry
+      if (building_)
+         back_->projections.push_back(Projection_t());
+
+      if (frontValid_)
+      {
+         front_->projections.push_back(Projection_t());
+         project(*front_, i);
+      }
+   }
+
+
+
+   // - ProjectedNodeIndex::removeNode -----------------------------------------
+   void ProjectedNodeIndex::removeNode(const NodePtr& node)
+   {
+      const boost::unordered_map<const osg::Node*, std::size_t>::iterator p =
+         entryIndices_.find(node.get());
+
+      if (p == entryIndices_.end())
+         return;
+
+      const std::size_t i = p->second;
+      const std::size_t last = entries_.size() - 1;
+
+      entryIndices_.erase(p);
+      removeFromGrids(i);
+
+      // Fill the hole with the last entry
+      if (i != last)
+      {
+         removeFromGrids(last);
+         entries_[i] = entries_[last];
+         entryIndices_[entries_[i].node.get()] = i;
+         projectInGrids(i);
+      }
+
+      entries_.pop_back();
+
+      if (frontValid_)
+         front_->projections.pop_back();
+
+      if (building_)
+      {
+         back_->projections.pop_back();
+         numProjected_ = std::min(numProjected_, entries_.size());
+      }
+   }
+
+
+
+   // - ProjectedNodeIndex::updateNode -----------------------------------------
+   void ProjectedNodeIndex::updateNode(const NodePtr& node)
+   {
+      const boost::unordered_map<const osg::Node*, std::size_t>::iterator p =
+         entryIndices_.find(node.get());
+
+      if (p == entryIndices_.end())
+         return;
+
+      const std::size_t i = p->second;
+
+      removeFromGrids(i);
+      entries_[i].center = computeCenter(*node);
+      projectInGrids(i);
+   }
+
+
+
+   // - ProjectedNodeIndex::update ---------------------------------------------
+   void ProjectedNodeIndex::update(std::size_t maxNodes)
+   {
+      // A grid being built is finished even if the camera keeps moving;
+      // otherwise, it would never be
+      if (!building_)
+      {
+         if (frontValid_ && !cameraMoved(*front_))
+            return;
+
+         startProjection();
+      }
+
+      const std::size_t end =
+         std::min(entries_.size(), numProjected_ + maxNodes);
+
+      for (/* nothing */; numProjected_ < end; ++numProjected_)
+         project(*back_, numProjected_);
+
+      if (numProjected_ == entries_.size())
+      {
+         std::swap(front_, back_);
+         frontValid_ = true;
+         building_ = false;
+      }
+   }
+
+
+
+   // - ProjectedNodeIndex::findNearest ----------------------------------------
+   NodePtr ProjectedNodeIndex::findNearest(const NodePtr& from,
+                                           Direction direction)
+   {
+      finishProjection();
+
+      const Grid_t& grid = *front_;
+
+      // Start from the node, or from the center of the screen
+      osg::Vec2 start(grid.origin.x() + grid.size.x() / 2.0f,
+                      grid.origin.y() + grid.size.y() / 2.0f);
+      std::size_t fromIndex = entries_.size();
+      bool directional = false;
+
+      const boost::unordered_map<const osg::Node*, std::size_t>::iterator p =
+         entryIndices_.find(from.get());
+
+      if (p != entryIndices_.end() && grid.projections[p->second].cell >= 0)
+      {
+         fromIndex = p->second;
+         start = grid.projections[fromIndex].position;
+         directional = true;
+      }
+
+      osg::Vec2 dir;
+      switch (direction)
+      {
+         case LEFT: dir = osg::Vec2(-1.0f, 0.0f); break;
+         case RIGHT: dir = osg::Vec2(1.0f, 0.0f); break;
+         case UP: dir = osg::Vec2(0.0f, 1.0f); break;
+         case DOWN: dir = osg::Vec2(0.0f, -1.0f); break;
+      }
+
+      const int startColumn = std::max(0, std::min(grid.numColumns - 1,
+         static_cast<int>((start.x() - grid.origin.x()) / cellSize_)));
+      const int startRow = std::max(0, std::min(grid.numRows - 1,
+         static_cast<int>((start.y() - grid.origin.y()) / cellSize_)));
+
+      // Look at rings of cells around the start, each one farther away
+      std::size_t best = entries_.size();
+      float bestScore = std::numeric_limits<float>::max();
+      const int maxRing = std::max(grid.numColumns, grid.numRows);
+
+      for (int r = 0; r <= maxRing; ++r)
+      {
+         // Nodes in this ring (or beyond) are too far to beat the best
+         if (best < entries_.size() && (r - 1) * cellSize_ > bestScore)
+            break;
+
+         for (int row = startRow - r; row <= startRow + r; ++row)
+         {
+            if (row < 0 || row >= grid.numRows)
+               continue;
+
+            if (directional && ((direction == UP && row < startRow)
+                                || (direction == DOWN && row > startRow)))
+            {
+               continue;
+            }
+
+            // Inner rows only have two cells in the ring
+            const bool edgeRow = row == startRow - r || row == startRow + r;
+            const int step = edgeRow ? 1 : 2 * r;
+
+            for (int col = startColumn - r; col <= startColumn + r; col += step)
+            {
+               if (col < 0 || col >= grid.numColumns)
+                  continue;
+
+               if (directional
+                   && ((direction == LEFT && col > startColumn)
+                       || (direction == RIGHT && col < startColumn)))
+               {
+                  continue;
+               }
+
+               const std::vector<std::size_t>& cell =
+                  grid.cells[row * grid.numColumns + col];
+
+               for (std::size_t k = 0; k < cell.size(); ++k)
+               {
+                  const std::size_t i = cell[k];
+                  if (i == fromIndex)
+                     continue;
+
+                  const osg::Vec2 v = grid.projections[i].position - start;
+                  float score;
+
+                  if (directional)
+                  {
+                     // Nodes off the way are penalized
+                     const float along = v * dir;
+                     if (along <= 0.0f)
+                        continue;
+
+                     const float across =
+                        std::fabs(v.x() * dir.y() - v.y() * dir.x());
+                     score = along + 2.0f * across;
+                  }
+                  else
+                  {
+                     score = v.length();
+                  }
+
+                  if (score < bestScore)
+                  {
+                     bestScore = score;
+                     best = i;
+                  }
+               }
+            }
+         }
+      }
+
+      return best < entries_.size() ? entries_[best].node : NodePtr();
+   }
+
+
+
+   // - ProjectedNodeIndex::cameraMoved ----------------------------------------
+   bool ProjectedNodeIndex::cameraMoved(const Grid_t& grid) const
+   {
+      const osg::Viewport* viewport = camera_->getViewport();
+      const osg::Vec2 origin = viewport != 0
+         ? osg::Vec2(viewport->x(), viewport->y())
+         : osg::Vec2();
+      const osg::Vec2 size = viewport != 0
+         ? osg::Vec2(viewport->width(), viewport->height())
+         : osg::Vec2();
+
+      return origin != grid.origin || size != grid.size
+         || camera_->getViewMatrix() * camera_->getProjectionMatrix()
+            != grid.viewProjection;
+   }
+
+
+
+   // - ProjectedNodeIndex::startProjection ------------------------------------
+   void ProjectedNodeIndex::startProjection()
+   {
+      Grid_t& grid = *back_;
+      const osg::Viewport* viewport = camera_->getViewport();
+
+      grid.viewProjection =
+         camera_->getViewMatrix() * camera_->getProjectionMatrix();
+      grid.origin = viewport != 0
+         ? osg::Vec2(viewport->x(), viewport->y())
+         : osg::Vec2();
+      grid.size = viewport != 0
+         ? osg::Vec2(viewport->width(), viewport->height())
+         : osg::Vec2();
+
+      grid.numColumns = std::max(1, static_cast<int>(
+                                   std::ceil(grid.size.x() / cellSize_)));
+      grid.numRows = std::max(1, static_cast<int>(
+                                std::ceil(grid.size.y() / cellSize_)));
+
+      // Cells keep their capacity, so rebuilding doesn't allocate
+      grid.cells.resize(grid.numColumns * grid.numRows);
+      for (std::size_t i = 0; i < grid.cells.size(); ++i)
+         grid.cells[i].clear();
+
+      grid.projections.resize(entries_.size());
+
+      numProjected_ = 0;
+      building_ = true;
+   }
+
+
+
+   // - ProjectedNodeIndex::finishProjection -----------------------------------
+   void ProjectedNodeIndex::finishProjection()
+   {
+      if (!frontValid_)
+         update(entries_.size());
+   }
+
+
+
+   // - ProjectedNodeIndex::project --------------------------------------------
+   void ProjectedNodeIndex::project(Grid_t& grid, std::size_t i)
+   {
+      Projection_t& projection = grid.projections[i];
+      projection.cell = -1;
+
+      const osg::Vec4d clip =
+         osg::Vec4d(entries_[i].center, 1.0) * grid.viewProjection;
+
+      if (clip.w() <= 0.0)
+         return; // behind the camera
+
+      const double x = clip.x() / clip.w();
+      const double y = clip.y() / clip.w();
+      const double z = clip.z() / clip.w();
+
+      if (x < -1.0 || x > 1.0 || y < -1.0 || y > 1.0 || z < -1.0 || z > 1.0)
+         return; // out of the view volume
+
+      projection.position =
+         osg::Vec2(grid.origin.x() + (x + 1.0) * 0.5 * grid.size.x(),
+                   grid.origin.y() + (y + 1.0) * 0.5 * grid.size.y());
+
+      const osg::Vec2 offset = projection.position - grid.origin;
+      const int col = std::min(grid.numColumns - 1,
+                               static_cast<int>(offset.x() / cellSize_));
+      const int row = std::min(grid.numRows - 1,
+                               static_cast<int>(offset.y() / cellSize_));
+
+      projection.cell = row * grid.numColumns + col;
+      grid.cells[projection.cell].push_back(i);
+   }
+
+
+
+   // - ProjectedNodeIndex::removeFromCell -------------------------------------
+   void ProjectedNodeIndex::removeFromCell(Grid_t& grid, std::size_t i)
+   {
+      Projection_t& projection = grid.projections[i];
+      if (projection.cell < 0)
+         return;
+
+      std::vector<std::size_t>& cell = grid.cells[projection.cell];
+      const std::vector<std::size_t>::iterator p =
+         std::find(cell.begin(), cell.end(), i);
+
+      assert(p != cell.end() && "Entry not found in its cell");
+
+      *p = cell.back();
+      cell.pop_back();
+      projection.cell = -1;
+   }
+
+
+
+   // - ProjectedNodeIndex::projectInGrids -------------------------------------
+   void ProjectedNodeIndex::projectInGrids(std::size_t i)
+   {
+      if (frontValid_)
+         project(*front_, i);
+
+      // Entries not projected yet in the grid being built will be later
+      if (building_ && i < numProjected_)
+         project(*back_, i);
+   }
+
+
+
+   // - ProjectedNodeIndex::removeFromGrids ------------------------------------
+   void ProjectedNodeIndex::removeFromGrids(std::size_t i)
+   {
+      if (frontValid_)
+         removeFromCell(*front_, i);
+
+      if (building_ && i < numProjected_)
+         removeFromCell(*back_, i);
+   }
+
+
+
+   // - ProjectedNodeIndex::computeCenter --------------------------------------
+   osg::Vec3d ProjectedNodeIndex::computeCenter(const osg::Node& node)
+   {
+      // The bound of a node is in the coordinates of its parent. Walk up
+      // through the first parents, like osg::computeLocalToWorld() would
+      // walk down, but without building a node path.
+      osg::Vec3d center = node.getBound().center();
+
+      const osg::Node* p = &node;
+      while (p->getNumParents() > 0)
+      {
+         p = p->getParent(0);
+
+         const osg::Transform* transform = p->asTransform();
+         if (transform == 0)
+            continue;
+
+         osg::Matrixd localToWorld;
+         transform->computeLocalToWorldMatrix(localToWorld, 0);
+         center = center * localToWorld;
+
+         // Whatever is above an absolute transform doesn't matter
+         if (transform->getReferenceFrame() == osg::Transform::ABSOLUTE_RF)
+            break;
+      }
+
+      return center;
+   }
+
+} // namespace OSGUIsh
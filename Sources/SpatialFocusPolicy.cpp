@@ -0,0 +1,58 @@
+/******************************************************************************\
+* SpatialFocusPolicy.cpp                                                       *
+* Moves the focus to the nearest node in the direction of an arrow key.        *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#include <OSGUIsh/SpatialFocusPolicy.hpp>
+
+
+namespace OSGUIsh
+{
+   // - SpatialFocusPolicy::updateFocus ----------------------------------------
+   void SpatialFocusPolicy::updateFocus(const osgGA::GUIEventAdapter& ea,
+                                        const NodePtr&)
+   {
+      typedef osgGA::GUIEventAdapter GEA;
+
+      switch (ea.getEventType())
+      {
+         case GEA::FRAME:
+            // Spread the work of following the camera over the frames
+            index_->update(nodesPerFrame_);
+            break;
+
+         case GEA::KEYDOWN:
+         {
+            typedef ProjectedNodeIndex PNI;
+            PNI::Direction direction;
+
+            switch (ea.getKey())
+            {
+               case GEA::KEY_Left: direction = PNI::LEFT; break;
+               case GEA::KEY_Right: direction = PNI::RIGHT; break;
+               case GEA::KEY_Up: direction = PNI::UP; break;
+               case GEA::KEY_Down: direction = PNI::DOWN; break;
+               default: return;
+            }
+
+            const NodePtr next =
+               index_->findNearest(getFocusedNode(), direction);
+
+            if (next.valid())
+               setFocusedNode(next);
+
+            break;
+         }
+
+         default:
+            break;
+      }
+   }
+
+} // namespace OSGUIsh
@@ -0,0 +1,118 @@
+/******************************************************************************\
+* Tracer.cpp                                                                   *
+* Writes Chrome trace-event files with the time spent in OSGUIsh.              *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#include <OSGUIsh/Tracer.hpp>
+#include <cstdio>
+#include <osg/Timer>
+
+
+namespace OSGUIsh
+{
+   // - Tracer::Tracer ---------------------------------------------------------
+   Tracer::Tracer(const std::string& fileName)
+      : file_(fileName.c_str()), hasSpans_(false)
+   {
+      file_ << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+   }
+
+
+
+   // - Tracer::~Tracer --------------------------------------------------------
+   Tracer::~Tracer()
+   {
+      close();
+   }
+
+
+
+   // - Tracer::now ------------------------------------------------------------
+   double Tracer::now()
+   {
+      return osg::Timer::instance()->time_u();
+   }
+
+
+
+   // - Tracer::addSpan --------------------------------------------------------
+   void Tracer::addSpan(const char* name, const char* category, double begin,
+                        double end, const char* argName,
+                        const std::string& argValue)
+   {
+      if (!file_.is_open())
+         return;
+
+      if (hasSpans_)
+         file_ << ",\n";
+
+      file_ << "{\"ph\":\"X\",\"pid\":1,\"tid\":1,\"name\":";
+      writeString(name);
+      file_ << ",\"cat\":";
+      writeString(category);
+      file_ << ",\"ts\":" << std::fixed << begin
+            << ",\"dur\":" << end - begin;
+
+      if (argName != 0)
+      {
+         file_ << ",\"args\":{";
+         writeString(argName);
+         file_ << ':';
+         writeString(argValue);
+         file_ << '}';
+      }
+
+      file_ << '}';
+
+      hasSpans_ = true;
+   }
+
+
+
+   // - Tracer::close ----------------------------------------------------------
+   void Tracer::close()
+   {
+      if (!file_.is_open())
+         return;
+
+      file_ << "\n]}\n";
+      file_.close();
+   }
+
+
+
+   // - Tracer::writeString ----------------------------------------------------
+   void Tracer::writeString(const std::string& str)
+   {
+      file_ << '"';
+
+      for (std::string::const_iterator p = str.begin(); p != str.end(); ++p)
+      {
+         const unsigned char c = *p;
+
+         if (c == '"' || c == '\\')
+         {
+            file_ << '\\' << c;
+         }
+         else if (c < 0x20)
+         {
+            char escaped[8];
+            std::sprintf(escaped, "\\u%04x", c);
+            file_ << escaped;
+         }
+         else
+         {
+            file_ << c;
+         }
+      }
+
+      file_ << '"';
+   }
+
+} // namespace OSGUIsh
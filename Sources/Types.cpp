@@ -37,4 +37,186 @@ namespace OSGUIsh
    { }
 
 
+
+   // - IntersectionView_t::IntersectionView_t ---------------------------------
+   IntersectionView_t::IntersectionView_t()
+      : source_(SOURCE_NONE), cached_(0)
+   {
+      hit_.intersection = 0;
+   }
+
+
+   IntersectionView_t::IntersectionView_t(
+      const osgUtil::LineSegmentIntersector::Intersection& hit)
+      : source_(SOURCE_LINE), cached_(0)
+   {
+      hit_.line = &hit;
+   }
+
+
+   IntersectionView_t::IntersectionView_t(
+      const osgUtil::PolytopeIntersector::Intersection& hit)
+      : source_(SOURCE_POLYTOPE), cached_(0)
+   {
+      hit_.polytope = &hit;
+   }
+
+
+   IntersectionView_t::IntersectionView_t(const Intersection_t& hit)
+      : source_(SOURCE_INTERSECTION), cached_(0)
+   {
+      hit_.intersection = &hit;
+   }
+
+
+
+   // - IntersectionView_t::getNodePath ----------------------------------------
+   const osg::NodePath& IntersectionView_t::getNodePath() const
+   {
+      static const osg::NodePath emptyPath;
+
+      switch (source_)
+      {
+         case SOURCE_LINE:
+            return hit_.line->nodePath;
+         case SOURCE_POLYTOPE:
+            return hit_.polytope->nodePath;
+         case SOURCE_INTERSECTION:
+            return hit_.intersection->nodePath;
+         default:
+            return emptyPath;
+      }
+   }
+
+
+
+   // - IntersectionView_t::getWorldIntersectionPoint --------------------------
+   const osg::Vec3d& IntersectionView_t::getWorldIntersectionPoint() const
+   {
+      if (!(cached_ & CACHED_WORLD_POINT))
+      {
+         switch (source_)
+         {
+            case SOURCE_LINE:
+               worldPoint_ = hit_.line->getWorldIntersectPoint();
+               break;
+            case SOURCE_POLYTOPE:
+               worldPoint_ = hit_.polytope->matrix.valid()
+                  ? hit_.polytope->localIntersectionPoint
+                     * (*hit_.polytope->matrix)
+                  : hit_.polytope->localIntersectionPoint;
+               break;
+            case SOURCE_INTERSECTION:
+               worldPoint_ = hit_.intersection->worldIntersectionPoint;
+               break;
+            default:
+               break;
+         }
+
+         cached_ |= CACHED_WORLD_POINT;
+      }
+
+      return worldPoint_;
+   }
+
+
+
+   // - IntersectionView_t::getWorldIntersectionNormal -------------------------
+   const osg::Vec3d& IntersectionView_t::getWorldIntersectionNormal() const
+   {
+      if (!(cached_ & CACHED_WORLD_NORMAL))
+      {
+         switch (source_)
+         {
+            case SOURCE_LINE:
+               worldNormal_ = hit_.line->getWorldIntersectNormal();
+               break;
+            case SOURCE_INTERSECTION:
+               worldNormal_ = hit_.intersection->worldIntersectionNormal;
+               break;
+            default: // no normals for polytope hits
+               break;
+         }
+
+         cached_ |= CACHED_WORLD_NORMAL;
+      }
+
+      return worldNormal_;
+   }
+
+
+
+   // - IntersectionView_t::getLocalIntersectionPoint --------------------------
+   const osg::Vec3d& IntersectionView_t::getLocalIntersectionPoint() const
+   {
+      if (!(cached_ & CACHED_LOCAL_POINT))
+      {
+         switch (source_)
+         {
+            case SOURCE_LINE:
+               localPoint_ = hit_.line->getLocalIntersectPoint();
+               break;
+            case SOURCE_POLYTOPE:
+               localPoint_ = hit_.polytope->localIntersectionPoint;
+               break;
+            case SOURCE_INTERSECTION:
+               localPoint_ = hit_.intersection->localIntersectionPoint;
+               break;
+            default:
+               break;
+         }
+
+         cached_ |= CACHED_LOCAL_POINT;
+      }
+
+      return localPoint_;
+   }
+
+
+
+   // - IntersectionView_t::getLocalIntersectionNormal -------------------------
+   const osg::Vec3d& IntersectionView_t::getLocalIntersectionNormal() const
+   {
+      if (!(cached_ & CACHED_LOCAL_NORMAL))
+      {
+         switch (source_)
+         {
+            case SOURCE_LINE:
+               localNormal_ = hit_.line->getLocalIntersectNormal();
+               break;
+            case SOURCE_INTERSECTION:
+               localNormal_ = hit_.intersection->localIntersectionNormal;
+               break;
+            default: // no normals for polytope hits
+               break;
+         }
+
+         cached_ |= CACHED_LOCAL_NORMAL;
+      }
+
+      return localNormal_;
+   }
+
+
+
+   // - IntersectionView_t::toIntersection -------------------------------------
+   Intersection_t IntersectionView_t::toIntersection() const
+   {
+      Intersection_t result;
+      copyTo(result);
+      return result;
+   }
+
+
+
+   // - IntersectionView_t::copyTo ---------------------------------------------
+   void IntersectionView_t::copyTo(Intersection_t& dest) const
+   {
+      dest.nodePath = getNodePath();
+      dest.worldIntersectionPoint = getWorldIntersectionPoint();
+      dest.worldIntersectionNormal = getWorldIntersectionNormal();
+      dest.localIntersectionPoint = getLocalIntersectionPoint();
+      dest.localIntersectionNormal = getLocalIntersectionNormal();
+   }
+
 } // namespace OSGUIsh
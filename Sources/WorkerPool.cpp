@@ -0,0 +1,155 @@
+/******************************************************************************\
+* WorkerPool.cpp                                                               *
+* A pool of worker threads used to run event handlers asynchronously.          *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#include <OSGUIsh/WorkerPool.hpp>
+#include <cassert>
+#include <OpenThreads/ScopedLock>
+
+
+namespace OSGUIsh
+{
+   // - WorkerPool::WorkerPool -------------------------------------------------
+   WorkerPool::WorkerPool(unsigned numThreads)
+   {
+      if (numThreads == 0)
+      {
+         const int numProcessors = OpenThreads::GetNumberOfProcessors();
+         numThreads = numProcessors > 2 ? numProcessors - 1 : 1;
+      }
+
+      for (unsigned i = 0; i < numThreads; ++i)
+      {
+         workers_.push_back(new Worker());
+         workers_.back()->start();
+      }
+   }
+
+
+
+   // - WorkerPool::~WorkerPool ------------------------------------------------
+   WorkerPool::~WorkerPool()
+   {
+      typedef std::vector<Worker*>::iterator iter_t;
+
+      // A worker cannot join itself
+      const OpenThreads::Thread* current = OpenThreads::Thread::CurrentThread();
+      for (iter_t p = workers_.begin(); p != workers_.end(); ++p)
+      {
+         assert(*p != current
+                && "A WorkerPool cannot be destroyed by one of its workers");
+      }
+
+      for (iter_t p = workers_.begin(); p != workers_.end(); ++p)
+         (*p)->stop();
+
+      for (iter_t p = workers_.begin(); p != workers_.end(); ++p)
+      {
+         (*p)->join();
+         delete *p;
+      }
+   }
+
+
+
+   // - WorkerPool::enqueue ----------------------------------------------------
+   void WorkerPool::enqueue(std::size_t key, const Task_t& task)
+   {
+      workers_[key % workers_.size()]->enqueue(task);
+   }
+
+
+
+   // - WorkerPool::Worker::Worker ---------------------------------------------
+   WorkerPool::Worker::Worker()
+      : done_(false)
+   {
+      // empty
+   }
+
+
+
+   // - WorkerPool::Worker::enqueue --------------------------------------------
+   void WorkerPool::Worker::enqueue(const Task_t& task)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+      tasks_.push_back(task);
+      condition_.signal();
+   }
+
+
+
+   // - WorkerPool::Worker::stop -----------------------------------------------
+   void WorkerPool::Worker::stop()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+      done_ = true;
+      condition_.signal();
+   }
+
+
+
+   // - WorkerPool::Worker::run ------------------------------------------------
+   void WorkerPool::Worker::run()
+   {
+      while (true)
+      {
+         Task_t task;
+
+         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+
+            while (tasks_.empty() && !done_)
+               condition_.wait(&mutex_);
+
+            if (tasks_.empty()) // and, therefore, 'done_'
+               return;
+
+            task.swap(tasks_.front());
+            tasks_.pop_front();
+         }
+
+         task();
+      }
+   }
+
+
+
+   // - MainThreadQueue::post --------------------------------------------------
+   void MainThreadQueue::post(const Task_t& task)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+      tasks_.push_back(task);
+   }
+
+
+
+   // - MainThreadQueue::runTasks ----------------------------------------------
+   std::size_t MainThreadQueue::runTasks()
+   {
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+         if (tasks_.empty())
+            return 0;
+
+         runningTasks_.swap(tasks_);
+      }
+
+      typedef std::vector<Task_t>::iterator iter_t;
+      for (iter_t p = runningTasks_.begin(); p != runningTasks_.end(); ++p)
+         (*p)();
+
+      const std::size_t numTasks = runningTasks_.size();
+      runningTasks_.clear(); // keeps the capacity for next time
+
+      return numTasks;
+   }
+
+} // namespace OSGUIsh
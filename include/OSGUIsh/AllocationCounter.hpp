@@ -0,0 +1,85 @@
+/******************************************************************************\
+* AllocationCounter.hpp                                                        *
+* An opt-in counter of heap allocations.                                       *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#ifndef _OSGUISH_ALLOCATION_COUNTER_HPP_
+#define _OSGUISH_ALLOCATION_COUNTER_HPP_
+
+#include <cstddef>
+
+
+namespace OSGUIsh
+{
+   /**
+    * Returns the number of heap allocations made so far, by all threads.
+    * This is always zero, unless the allocation counter is enabled.
+    *
+    * To enable the allocation counter, define \c
+    * OSGUISH_DEFINE_ALLOCATION_COUNTER before including this header, in
+    * exactly one source file of the application. This replaces the global
+    * <tt>operator new</tt> and <tt>operator delete</tt> with versions that
+    * count allocations (and otherwise just call \c std::malloc() and \c
+    * std::free()).
+    *
+    * @see EventHandler::getNumAllocationsInLastHandle()
+    */
+   std::size_t GetAllocationCount();
+
+   /// Increments the allocation counter. Used by the replaced operators.
+   void CountAllocation();
+
+} // namespace OSGUIsh
+
+
+#ifdef OSGUISH_DEFINE_ALLOCATION_COUNTER
+
+#include <cstdlib>
+#include <new>
+
+#if __cplusplus >= 201103L
+#  define OSGUISH_THROW_BAD_ALLOC
+#  define OSGUISH_THROW_NOTHING noexcept
+#else
+#  define OSGUISH_THROW_BAD_ALLOC throw(std::bad_alloc)
+#  define OSGUISH_THROW_NOTHING throw()
+#endif
+
+void* operator new(std::size_t size) OSGUISH_THROW_BAD_ALLOC
+{
+   OSGUIsh::CountAllocation();
+
+   void* p = std::malloc(size > 0 ? size : 1);
+   if (p == 0)
+      throw std::bad_alloc();
+
+   return p;
+}
+
+void* operator new[](std::size_t size) OSGUISH_THROW_BAD_ALLOC
+{
+   return operator new(size);
+}
+
+void operator delete(void* p) OSGUISH_THROW_NOTHING
+{
+   std::free(p);
+}
+
+void operator delete[](void* p) OSGUISH_THROW_NOTHING
+{
+   std::free(p);
+}
+
+#undef OSGUISH_THROW_BAD_ALLOC
+#undef OSGUISH_THROW_NOTHING
+
+#endif // OSGUISH_DEFINE_ALLOCATION_COUNTER
+
+#endif // _OSGUISH_ALLOCATION_COUNTER_HPP_
@@ -12,13 +12,24 @@
 #ifndef _OSGUISH_EVENT_HANDLER_HPP_
 #define _OSGUISH_EVENT_HANDLER_HPP_
 
+#include <set>
+#include <boost/function.hpp>
 #include <boost/signal.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 #include <osgGA/GUIEventHandler>
 #include <osgUtil/LineSegmentIntersector>
+#include <osg/Vec2>
 #include <osg/View>
+#include <OSGUIsh/EventRecorder.hpp>
 #include <OSGUIsh/Events.hpp>
 #include <OSGUIsh/FocusPolicy.hpp>
+#include <OSGUIsh/HandlerProfiler.hpp>
+#include <OSGUIsh/LatencyMonitor.hpp>
 #include <OSGUIsh/ManualFocusPolicy.hpp>
+#include <OSGUIsh/PickingStats.hpp>
+#include <OSGUIsh/Tracer.hpp>
+#include <OSGUIsh/WorkerPool.hpp>
 
 
 namespace OSGUIsh
@@ -27,8 +38,8 @@ namespace OSGUIsh
     * A \c struct grouping parameters passed to event handlers. Future versions
     * of OSGUish may add more members here if necessary without breaking
     * existing user code.
-    * @note Be aware that, in the general case, <tt>hit.nodePath.back() !=
-    *       node</tt>. \c hit contains the actual, "low level" hit, while \c
+    * @note Be aware that, in the general case, <tt>hit.getNodePath().back()
+    *       != node</tt>. \c hit contains the actual, "low level" hit, while \c
     *       node contains the node registered with OSGUish. For instance,
     *       suppose you register a car node, that has a car body node and four
     *       wheel nodes as subnodes. \c node will always be the whole car, while
@@ -40,11 +51,17 @@ namespace OSGUIsh
          /// Convenience constructor.
          HandlerParams(NodePtr nodeParam,
                        const osgGA::GUIEventAdapter& eventParam,
-                       const Intersection_t& hitParam)
-            : node(nodeParam), event(eventParam), hit(hitParam)
+                       const IntersectionView_t& hitParam)
+            : node(nodeParam), event(eventParam), hit(hitParam),
+              target(nodeParam), phase(PHASE_TARGET), motion(0), drag(0),
+              propagationStopped_(false), consumed_(false)
          { }
 
-         /// The node generating the event.
+         /**
+          * The node generating the event. When event propagation is enabled,
+          * this is the node currently handling the event, which may be an
+          * ancestor of \c target.
+          */
          NodePtr node;
 
          /**
@@ -54,9 +71,12 @@ namespace OSGUIsh
          const osgGA::GUIEventAdapter& event;
 
          /**
-          * The \c Intersection_t for the node that was under the mouse pointer
-          * when the event was generated.
-          * @note Notice that, in some cases, the \c Intersection_t for the node
+          * The intersection for the node that was under the mouse pointer when
+          * the event was generated. This is just a view of the data produced
+          * while picking, and values like the world intersection point are
+          * computed only if requested. Use \c hit.toIntersection() if you
+          * need to keep a copy of it.
+          * @note Notice that, in some cases, the intersection for the node
           *       under the mouse pointer doesn't really have something to do
           *       with the event being handled. For example, if the event is a
           *       \c KeyUp and the focus policy is not the "node under mouse has
@@ -67,7 +87,146 @@ namespace OSGUIsh
           *       the mouse pointer. Figuring out if \c hit contains valid and
           *       meaningful information is up to the user.
           */
-         const Intersection_t& hit;
+         const IntersectionView_t& hit;
+
+         /**
+          * The registered node the event is targeted at; that is, the deepest
+          * registered node in <tt>hit.getNodePath()</tt>. Unless event
+          * propagation is enabled, this is always equal to \c node.
+          */
+         NodePtr target;
+
+         /// The propagation phase the event is in.
+         EventPhase phase;
+
+         /**
+          * For <tt>"MouseEnter"</tt>, <tt>"MouseLeave"</tt> and
+          * <tt>"MouseMove"</tt> generated at a frame, all the mouse positions
+          * OSG reported since the previous frame, oldest first. (Picking
+          * itself is done only once per frame, at the last position.) This is
+          * \c NULL if the mouse didn't move, and for other events.
+          * @note This refers to data owned by the \c EventHandler, which is
+          *       reused at the next frame.
+          * @note The samples are passed only along with these events: if,
+          *       at the end of a frame, the mouse is over no node and
+          *       didn't leave one, the samples of that frame are not
+          *       delivered to anybody. With swept picking enabled, nodes
+          *       crossed in between still get their events (and samples).
+          * @see EventHandler::setMaxMotionSamples()
+          */
+         const MotionSamples_t* motion;
+
+         /**
+          * For <tt>"DragStart"</tt>, <tt>"Drag"</tt> and <tt>"DragEnd"</tt>,
+          * the state of the drag. This is \c NULL for other events.
+          * @note This refers to data owned by the \c EventHandler, valid
+          *       only during the handler call. With deferred dispatch, it
+          *       is the state when the event was generated, not when it was
+          *       dispatched.
+          */
+         const DragInfo_t* drag;
+
+         /**
+          * For <tt>"MouseWheel"</tt>, the wheel motion accumulated since the
+          * previous frame: \c y is positive when the wheel is rolled up
+          * (forward), and \c x is positive when it is moved right. One notch
+          * of a regular wheel counts as one. This is zero for other events.
+          */
+         osg::Vec2 wheelDelta;
+
+         /**
+          * Stops the propagation of the event: no other node will receive it
+          * after the current one. (Other handlers connected to the current
+          * node's signal will still be called.)
+          */
+         void stopPropagation() { propagationStopped_ = true; }
+
+         /// Checks whether \c stopPropagation() has been called.
+         bool isPropagationStopped() const { return propagationStopped_; }
+
+         /**
+          * Marks the event as consumed, so that \c EventHandler::handle()
+          * returns \c true for it and other OSG event handlers (like camera
+          * manipulators) don't process it. This doesn't stop the event
+          * propagation within OSGUIsh.
+          */
+         void consume() { consumed_ = true; }
+
+         /// Checks whether \c consume() has been called.
+         bool isConsumed() const { return consumed_; }
+
+      private:
+         /// Has \c stopPropagation() been called?
+         bool propagationStopped_;
+
+         /// Has \c consume() been called?
+         bool consumed_;
+   };
+
+
+
+   /**
+    * The parameters passed to event handlers running asynchronously, in a
+    * worker thread (see \c EventHandler::makeAsyncSlot()). Unlike \c
+    * HandlerParams, this doesn't refer to any data owned by the \c
+    * EventHandler: everything is copied, so that it is safe to use this while
+    * the frame thread goes on.
+    */
+   struct AsyncHandlerParams
+   {
+      public:
+         /**
+          * Constructs an \c AsyncHandlerParams from the \c HandlerParams
+          * passed to the synchronous signal handler.
+          * @param params The parameters to copy.
+          * @param queue The queue of tasks run by the \c EventHandler in the
+          *        main thread.
+          */
+         AsyncHandlerParams(const HandlerParams& params,
+                            MainThreadQueuePtr queue);
+
+         /// The node generating the event (as in \c HandlerParams).
+         NodePtr node;
+
+         /// The event data, as passed by OSG.
+         osg::ref_ptr<const osgGA::GUIEventAdapter> event;
+
+         /// A copy of the hit under the mouse (as in \c HandlerParams).
+         Intersection_t hit;
+
+         /// The node the event is targeted at (as in \c HandlerParams).
+         NodePtr target;
+
+         /// The propagation phase the event was in.
+         EventPhase phase;
+
+         /**
+          * A copy of the mouse positions reported between frames (empty if
+          * \c HandlerParams::motion was \c NULL).
+          */
+         MotionSamples_t motion;
+
+         /// A copy of the drag state (meaningful only for drag events).
+         DragInfo_t drag;
+
+         /// The wheel motion (as in \c HandlerParams).
+         osg::Vec2 wheelDelta;
+
+         /**
+          * Posts a task to be run in the main thread, at the start of the next
+          * frame. Asynchronous handlers must not touch the scene graph
+          * directly; this is the way to deliver their results.
+          */
+         void postToMainThread(const MainThreadQueue::Task_t& task)
+         { queue_->post(task); }
+
+      private:
+         /**
+          * The queue of tasks run by the \c EventHandler in the main thread.
+          * (Not the \c WorkerPool: the last reference to it must not be
+          * dropped in a worker thread.)
+          */
+         MainThreadQueuePtr queue_;
    };
 
 
@@ -106,11 +265,38 @@ namespace OSGUIsh
 
          /**
           * Handles upcoming events (overloads virtual method).
-          * @return See \c handleReturnValues_, please.
+          * @return \c true if the event was consumed, and therefore shall not
+          *         be processed by other OSG event handlers. An event is
+          *         consumed if \c setHandleReturnValue() says so for its type,
+          *         if it was delivered to a node for which \c
+          *         setConsumesEvents() was called, or if any handler called \c
+          *         HandlerParams::consume(). Also, once a mouse button press is
+          *         consumed, the drags and the release that follow it are
+          *         consumed as well.
           */
          bool handle(const osgGA::GUIEventAdapter& ea,
                      osgGA::GUIActionAdapter&);
 
+         /**
+          * Sets the value returned by \c handle() for a given event type,
+          * regardless of what OSGUIsh does with the event. By default, this is
+          * \c false for all event types.
+          * @param eventType The OSG event type.
+          * @param value The value to return for events of this type.
+          */
+         void setHandleReturnValue(
+            osgGA::GUIEventAdapter::EventType eventType, bool value);
+
+         /**
+          * Makes every event delivered to a given node to be consumed (see \c
+          * handle()). This is the simplest way to keep camera manipulators
+          * from rotating the scene when an interactive node is clicked or
+          * dragged.
+          * @param node The node. Must be registered with \c addNode().
+          * @param consumes Consume events delivered to \c node?
+          */
+         void setConsumesEvents(const NodePtr node, bool consumes = true);
+
          /// A type representing a sequence of node masks.
          typedef std::vector<osg::Node::NodeMask> NodeMasks_t;
 
@@ -193,11 +379,20 @@ namespace OSGUIsh
          /// A (smart) pointer to a \c Signal_t;
          typedef boost::shared_ptr<Signal_t> SignalPtr;
 
+         /// A function that can be connected to a \c Signal_t.
+         typedef boost::function<void (HandlerParams&)> Slot_t;
+
+         /// A signal handler to be run asynchronously, in a worker thread.
+         typedef boost::function<void (AsyncHandlerParams&)> AsyncSlot_t;
+
          /**
           * Adds a given node to the list of nodes being "observed" by this \c
           * EventHandler. In other words, after this call, signals for this node
           * will be triggered.
           * @param node The node that will be added to this \c EventHandler.
+          * @note This is cheap: the per-node signals are created only when
+          *       first requested through \c getSignal(). Adding an already
+          *       added node is harmless, and keeps its existing connections.
           */
          void addNode(const NodePtr node);
 
@@ -213,6 +408,249 @@ namespace OSGUIsh
 
          SignalPtr getSignal(const NodePtr node, Event signal);
 
+         /**
+          * Returns a handler-wide signal for a given event. This signal is
+          * triggered whenever \c signal is triggered for \e any registered
+          * node, right after the node's own signal (the one returned by \c
+          * getSignal()). Use \c HandlerParams::node to know which node
+          * generated the event.
+          *
+          * This is the way to go when the same handler is used for lots of
+          * nodes: one single connection serves all of them, instead of one
+          * connection per node.
+          * @param signal The desired signal.
+          */
+         SignalPtr getGlobalSignal(Event signal);
+
+         /**
+          * Returns the capture-phase signal associated with a given node. It
+          * is triggered when an event targeted at a descendant of \c node is
+          * on its way down the node path, before the descendant itself (and
+          * before the usual, bubble-phase signal returned by \c getSignal())
+          * gets it. This is only used if event propagation is enabled.
+          * @param node The desired node.
+          * @param signal The desired signal.
+          * @see setEventPropagation()
+          */
+         SignalPtr getCaptureSignal(const NodePtr node, Event signal);
+
+         /**
+          * Returns a signal associated with a given key on a given node. It
+          * is triggered (right after the node's \c EVENT_KEY_DOWN or \c
+          * EVENT_KEY_UP signal) only when that key, with exactly the given
+          * modifiers, is pressed or released while the node has the keyboard
+          * focus. The key bindings of all nodes live in a single hash table,
+          * so the cost of a key event doesn't grow with the number of
+          * bindings, and handlers don't need to check the key themselves.
+          * @param node The desired node.
+          * @param signal Either \c EVENT_KEY_DOWN or \c EVENT_KEY_UP.
+          * @param key The key, as in \c osgGA::GUIEventAdapter::getKey().
+          * @param modKeyMask The modifier keys, as a combination of \c
+          *        osgGA::GUIEventAdapter::ModKeyMask values. Left and right
+          *        modifiers are not told apart, and lock keys are ignored.
+          */
+         SignalPtr getKeySignal(const NodePtr node, Event signal, int key,
+                                unsigned modKeyMask = 0);
+
+         /**
+          * Returns a handler-wide signal associated with a given key (see \c
+          * getKeySignal()). Unlike the signals returned by \c
+          * getGlobalSignal(), this is triggered even if no node has the
+          * keyboard focus; in this case, \c HandlerParams::node is \c NULL.
+          * @param signal Either \c EVENT_KEY_DOWN or \c EVENT_KEY_UP.
+          * @param key The key, as in \c osgGA::GUIEventAdapter::getKey().
+          * @param modKeyMask The modifier keys (see \c getKeySignal()).
+          */
+         SignalPtr getGlobalKeySignal(Event signal, int key,
+                                      unsigned modKeyMask = 0);
+
+         /**
+          * Enables or disables DOM-like event propagation. When enabled, mouse
+          * events (except \c EVENT_MOUSE_ENTER and \c EVENT_MOUSE_LEAVE) are
+          * not delivered only to the deepest registered node under the mouse,
+          * but to every registered node along the hit node path: first the
+          * capture signals, from the root down to the target, then the target,
+          * and finally the regular signals, from the target up to the root.
+          * Any handler can call \c HandlerParams::stopPropagation() to stop
+          * this.
+          *
+          * So, registering just the root of an assembly is enough to handle
+          * events on all of its parts; the part actually hit can still be
+          * found in <tt>hit.getNodePath()</tt>.
+          * @param enable Enable propagation? (It is disabled by default.)
+          */
+         void setEventPropagation(bool enable = true)
+         { eventPropagation_ = enable; }
+
+         /**
+          * Enables or disables deferred event dispatch. By default, signals
+          * are triggered right from \c handle(), that is, during OSG's event
+          * traversal. When deferred dispatch is enabled, the events generated
+          * there are just stored in a queue, and the signals are triggered
+          * only when \c dispatchDeferredEvents() is called. This way, the
+          * application can choose when its handlers run (for example, from an
+          * update callback, where changing the scene graph is safe), and
+          * expensive handlers no longer stall input processing.
+          * @param enable Enable deferred dispatch?
+          * @param capacity The number of events the queue can hold before it
+          *        needs to grow. Memory for this many events is allocated
+          *        upfront, so that queuing events doesn't allocate in the
+          *        common case.
+          * @note Disabling deferred dispatch with events still queued doesn't
+          *       discard them: they will be dispatched by the next call to
+          *       \c dispatchDeferredEvents().
+          */
+         void setDeferredDispatch(bool enable = true,
+                                  std::size_t capacity = 256);
+
+         /**
+          * Triggers the signals for all queued events, in the order they were
+          * generated, and empties the queue. Only useful if deferred dispatch
+          * is enabled.
+          * @note Successive "mouse move" events on the same node with nothing
+          *       in between are merged into a single one (the latest) when
+          *       queued, so handlers see at most one of them per batch.
+          * @see setDeferredDispatch()
+          */
+         void dispatchDeferredEvents();
+
+         /// Returns the number of events waiting in the deferred queue.
+         std::size_t getNumDeferredEvents() const
+         { return deferredCount_; }
+
+         /**
+          * Wraps a handler so that it runs in a worker thread instead of in
+          * the frame thread. The returned slot can be connected to any signal,
+          * like this:
+          * <tt>handler->getSignal(node, EVENT_CLICK)->connect(
+          *    handler->makeAsyncSlot(&MySlowHandler));</tt>
+          *
+          * When the signal is triggered, the frame thread just copies the
+          * event parameters and enqueues the handler in the \c WorkerPool.
+          * Handlers for events on the same node run in the order the events
+          * were generated. Results must be delivered back to the main thread
+          * through \c AsyncHandlerParams::postToMainThread().
+          * @param slot The handler to run asynchronously.
+          * @note Asynchronous handlers cannot stop the event propagation.
+          */
+         Slot_t makeAsyncSlot(const AsyncSlot_t& slot);
+
+         /**
+          * Sets the \c WorkerPool used to run asynchronous handlers. Handlers
+          * already created by \c makeAsyncSlot() keep using the previous pool
+          * (which lives as long as they do); the results they post to the
+          * main thread are still delivered.
+          */
+         void setWorkerPool(WorkerPoolPtr pool) { workerPool_ = pool; }
+
+         /**
+          * Returns the \c WorkerPool used to run asynchronous handlers. If
+          * none was set, one with default settings is created.
+          */
+         WorkerPoolPtr getWorkerPool();
+
+         /**
+          * Sets the \c HandlerProfiler used to time event handlers. Passing a
+          * null pointer (the default) disables profiling, and in this case
+          * no timing overhead is added to event dispatching.
+          */
+         void setProfiler(HandlerProfilerPtr profiler) { profiler_ = profiler; }
+
+         /// Returns the \c HandlerProfiler in use (possibly null).
+         HandlerProfilerPtr getProfiler() const { return profiler_; }
+
+         /**
+          * Enables or disables the collection of picking statistics (see \c
+          * PickingStats). They are also collected whenever the viewer stats
+          * have the \c PICKING_STATS_NAME collection enabled, and in this
+          * case they are also written there, for every frame. (\c
+          * AddPickingStatsLines() does this, and shows them on screen.)
+          */
+         void setCollectPickingStats(bool collect = true)
+         { collectPickingStats_ = collect; }
+
+         /**
+          * Returns the picking statistics of the last frame during which
+          * statistics were collected.
+          */
+         const PickingStats& getPickingStats() const
+         { return lastPickingStats_; }
+
+         /**
+          * Sets the \c EventRecorder that will record every event seen by \c
+          * handle(). Passing a null pointer (the default) stops recording.
+          * @see EventReplayer for playing the recording back.
+          */
+         void setEventRecorder(EventRecorderPtr recorder)
+         { recorder_ = recorder; }
+
+         /// Returns the \c EventRecorder in use (possibly null).
+         EventRecorderPtr getEventRecorder() const { return recorder_; }
+
+         /**
+          * Returns the number of heap allocations made during the last call
+          * to \c handle(). Useful to catch regressions in the steady-state
+          * frame path, which is not supposed to allocate anything in OSGUIsh
+          * itself. OSG still allocates while picking, though. A line pick
+          * (the default) costs five allocations for the camera, as OSG keeps
+          * its matrix and intersector stacks in lists, plus about seven for
+          * each hit recorded (the hit, its node path and its index lists,
+          * and the copies OSG keeps of them). Transforms visited, polytope
+          * picks and swept picks allocate more.
+          * @note This is always zero unless the allocation counter is
+          *       enabled. See \c GetAllocationCount().
+          */
+         std::size_t getNumAllocationsInLastHandle() const
+         { return lastHandleAllocations_; }
+
+         /**
+          * Sets the \c Tracer recording where \c handle() spends its time.
+          * Passing a null pointer (the default) disables tracing.
+          */
+         void setTracer(TracerPtr tracer) { tracer_ = tracer; }
+
+         /// Returns the \c Tracer in use (possibly null).
+         TracerPtr getTracer() const { return tracer_; }
+
+         /**
+          * Sets the maximum number of mouse positions kept between frames
+          * and passed to the handlers in \c HandlerParams::motion. When more
+          * positions than this are reported in a single frame, the last one
+          * replaces the previous. Zero disables collecting them. The default
+          * is 128.
+          */
+         void setMaxMotionSamples(std::size_t maxSamples);
+
+         /// Returns the maximum number of mouse positions kept between frames.
+         std::size_t getMaxMotionSamples() const { return maxMotionSamples_; }
+
+         /**
+          * Sets the \c LatencyMonitor collecting the input-to-dispatch
+          * latencies. Passing a null pointer (the default) disables the
+          * measurement.
+          * @note Samples are only recorded after the first \c FRAME event is
+          *       seen, because it is needed to relate the time of OSG events
+          *       to the current time.
+          */
+         void setLatencyMonitor(LatencyMonitorPtr monitor)
+         { latencyMonitor_ = monitor; }
+
+         /**
+          * Sets the scrolling delta equivalent to one notch of a regular
+          * mouse wheel. Smooth-scrolling devices (like touchpads) report
+          * small, fractional deltas (OSG's \c SCROLL_2D); these are added up
+          * and one <tt>"MouseWheelUp"</tt> or <tt>"MouseWheelDown"</tt> is
+          * generated whenever they sum up to a notch. The default is 1.
+          */
+         void setWheelNotch(float notch);
+
+         /// Returns the scrolling delta equivalent to one wheel notch.
+         float getWheelNotch() const { return wheelNotch_; }
+
+         /// Returns the \c LatencyMonitor in use (possibly null).
+         LatencyMonitorPtr getLatencyMonitor() const
+         { return latencyMonitor_; }
+
          /**
           * Ignores or stops to ignore faces that are back-facing the viewer
           * when picking. It may be useful to ignore back faces when backface
@@ -225,6 +663,137 @@ namespace OSGUIsh
          void ignoreBackFaces(bool ignore = true)
          { ignoreBackFaces_ = ignore; }
 
+         /**
+          * Makes mouse button events pick at their own coordinates, or stop
+          * doing so. By default, <tt>"MouseDown"</tt>, <tt>"MouseUp"</tt>,
+          * <tt>"Click"</tt> and <tt>"DoubleClick"</tt> go to the node found
+          * under the mouse in the last \c FRAME, which, on slow frames, may
+          * not be under the mouse anymore when the button is pressed. With
+          * this enabled, \c PUSH and \c RELEASE pick again (generating any
+          * pending <tt>"MouseEnter"</tt> and <tt>"MouseLeave"</tt> events
+          * first).
+          * @note A pick is skipped when the previous one, in the same frame,
+          *       used the same mouse position and camera. So, when the mouse
+          *       doesn't move, a click and the following \c FRAME share a
+          *       single pick.
+          */
+         void setPickOnButtonEvents(bool pick = true)
+         { pickOnButtonEvents_ = pick; }
+
+         /// Do mouse button events pick at their own coordinates?
+         bool getPickOnButtonEvents() const { return pickOnButtonEvents_; }
+
+         /**
+          * Makes a registered node draggable. Pressing a mouse button over it
+          * will generate a <tt>"DragStart"</tt>, and the node will capture
+          * the mouse until the button is released: no picking is done
+          * meanwhile (so no <tt>"MouseEnter"</tt>, <tt>"MouseLeave"</tt> or
+          * <tt>"MouseMove"</tt> are generated), and the mouse position is
+          * just projected on the constraint, which costs a single
+          * ray-plane (or ray-line) intersection per frame. The result is
+          * passed to the <tt>"Drag"</tt> and <tt>"DragEnd"</tt> handlers in
+          * \c HandlerParams::drag.
+          * @note While dragging, \c DRAG events are consumed, so that camera
+          *       manipulators don't react to them. A drag that moved the node
+          *       doesn't generate a <tt>"Click"</tt>.
+          */
+         void setDragConstraint(const NodePtr node,
+                                const DragConstraint_t& constraint);
+
+         /// Makes a node not draggable anymore.
+         void removeDragConstraint(const NodePtr node);
+
+         /// Returns the node being dragged (null if none).
+         NodePtr getDraggedNode() const { return dragNode_; }
+
+         /**
+          * Makes picking go on while a node is dragged, or stop doing so
+          * (the default). With this enabled, the dragged node is left out of
+          * picking, and the nodes under it get the usual
+          * <tt>"MouseEnter"</tt>, <tt>"MouseLeave"</tt> and
+          * <tt>"MouseMove"</tt> events. This is what drop targets need; in
+          * particular, \c getNodeUnderMouse() returns the drop target in the
+          * <tt>"DragEnd"</tt> handlers.
+          * @note The dragged node gets a <tt>"MouseLeave"</tt> in the first
+          *       frame of the drag, since it is not picked anymore.
+          */
+         void setPickWhileDragging(bool pick = true)
+         { pickWhileDragging_ = pick; }
+
+         /// Does picking go on while a node is dragged?
+         bool getPickWhileDragging() const { return pickWhileDragging_; }
+
+         /// Returns the node found under the mouse in the last pick.
+         NodePtr getNodeUnderMouse() const { return nodeUnderMouse_; }
+
+         /**
+          * Makes picking ignore a subtree. Unlike a picking mask, this
+          * doesn't require changing the node masks of the scene graph (which
+          * also affect culling); the subtree is skipped as soon as the
+          * picking traversal reaches \c node, so excluding a subtree makes
+          * picking cheaper, not more expensive.
+          * @note The node is not referenced by this \c EventHandler; remove
+          *       it from the exclusions before deleting it.
+          */
+         void addPickExclusion(const NodePtr node);
+
+         /// Makes picking stop ignoring a subtree.
+         void removePickExclusion(const NodePtr node);
+
+         /// Makes picking stop ignoring all subtrees.
+         void clearPickExclusions();
+
+         /**
+          * Enables or disables swept picking. Normally, the node under the
+          * mouse is looked for only at the mouse position of each frame, so
+          * that the mouse can cross a thin node between two frames without
+          * it getting any event. With swept picking, the path followed by
+          * the mouse since the last pick (see \c HandlerParams::motion) is
+          * also picked, at regular steps, and the <tt>"MouseEnter"</tt> and
+          * <tt>"MouseLeave"</tt> events for the nodes crossed are generated
+          * in order. All the points of the path are picked in a single
+          * traversal (per picking mask).
+          * @param enable Enable swept picking?
+          * @param pixelStep The distance, in pixels, between the points
+          *        picked along the path.
+          * @param maxSamples The maximum number of points picked along the
+          *        path at each frame. Longer paths are picked with a larger
+          *        step.
+          * @note Swept picking requires mouse positions to be collected (see
+          *       \c setMaxMotionSamples()).
+          */
+         void setSweptPicking(bool enable, float pixelStep = 2.0f,
+                              std::size_t maxSamples = 64);
+
+         /// Is swept picking enabled?
+         bool getSweptPicking() const { return sweptPicking_; }
+
+         /**
+          * Sets the radius of the picking region, which selects the kind of
+          * intersector used for picking. See the constructor for details.
+          * This can be changed at any time; the new value is used from the
+          * next frame on.
+          */
+         void setPickerRadius(double pickerRadius);
+
+         /// Returns the radius of the picking region.
+         double getPickerRadius() const { return pickerRadius_; }
+
+         /**
+          * Makes picking use or stop using the \c osg::KdTree of the
+          * drawables that have one (they can be built by an \c
+          * osg::KdTreeBuilder, or when loading models if requested by the \c
+          * osgDB::Registry). KD-trees are used by default, and only
+          * accelerate picking with a line segment (that is, when the picker
+          * radius is zero).
+          */
+         void setUseKdTrees(bool use = true)
+         { pickVisitor_->setUseKdTreeWhenAvailable(use); }
+
+         /// Are KD-trees used for picking, when available?
+         bool getUseKdTrees() const
+         { return pickVisitor_->getUseKdTreeWhenAvailable(); }
+
          /**
           * Manually sets the node that will receive keyboard events. Notice
           * that focus policies allow to set this automatically.
@@ -241,17 +810,22 @@ namespace OSGUIsh
           * Sets the focus policy for keyboard events to a given one.
           * @param policyFactory The factory that will be used to create the
           *        actual policy.
+          * @throw std::runtime_error In a \c StaticEventHandler, whose
+          *        policies cannot be changed.
           */
-         void setKeyboardFocusPolicy(const FocusPolicyFactory& policyFactory);
+         virtual void setKeyboardFocusPolicy(
+            const FocusPolicyFactory& policyFactory);
 
          /**
           * Sets the focus policy for mouse wheel events to a given one.
           * @param policyFactory The factory that will be used to create the
           *        actual policy.
+          * @throw std::runtime_error In a \c StaticEventHandler, whose
+          *        policies cannot be changed.
           */
-         void setMouseWheelFocusPolicy(const FocusPolicyFactory& policyFactory);
+         virtual void setMouseWheelFocusPolicy(
+            const FocusPolicyFactory& policyFactory);
 
-      private:
          /**
           * Returns the first node in an \c osg::NodePath that is present in the
           * list of nodes being "observed" by this \c EventHandler. This is
@@ -263,7 +837,97 @@ namespace OSGUIsh
           * @returns The first node in \c nodePath that was added to the list of
           *          nodes being observed.
           */
-         NodePtr getObservedNode(const osg::NodePath& nodePath);
+         NodePtr getObservedNode(const osg::NodePath& nodePath) const;
+
+      protected:
+         /**
+          * Updates the keyboard and mouse wheel focus. This is called for
+          * every event arriving via OSG, after the signals are called. The
+          * default implementation calls the focus policies (see \c
+          * setKeyboardFocusPolicy() and \c setMouseWheelFocusPolicy());
+          * \c StaticEventHandler replaces them with policies chosen at
+          * compile time.
+          * @param ea The event generated by OSG.
+          * @param nodeUnderMouse The node under the mouse pointer.
+          */
+         virtual void updateFocus(const osgGA::GUIEventAdapter& ea,
+                                  const NodePtr& nodeUnderMouse);
+
+         /// Returns the node receiving keyboard events, for focus policies.
+         NodePtr& getKeyboardFocusRef() { return kbdFocus_; }
+
+         /// Returns the node receiving mouse wheel events, for focus policies.
+         NodePtr& getMouseWheelFocusRef() { return wheelFocus_; }
+
+      private:
+         /**
+          * Triggers the signals associated with a given event: first the
+          * signal of \c params.node (if it was ever requested), then the
+          * global signal (if \c params.node is valid) and, for key events,
+          * the matching key signals.
+          * @param event The event being triggered.
+          * @param params The parameters passed to the signal handlers.
+          */
+         void fireSignal(Event event, HandlerParams& params);
+
+         /**
+          * Triggers the key signals matching a key event: first the one of \c
+          * params.node, then the global one.
+          * @param event Either \c EVENT_KEY_DOWN or \c EVENT_KEY_UP.
+          * @param params The parameters passed to the signal handlers.
+          */
+         void fireKeySignals(Event event, HandlerParams& params);
+
+         /**
+          * Like \c fireSignal(), but for the capture-phase signals. (Global
+          * signals are not triggered here.)
+          */
+         void fireCaptureSignal(Event event, HandlerParams& params);
+
+         /**
+          * Delivers an event to \c params.target. If event propagation is
+          * enabled and \c event is a propagating event, this goes through the
+          * capture, target and bubble phases; otherwise, this just calls \c
+          * fireSignal().
+          * @param event The event being delivered.
+          * @param params The parameters passed to the signal handlers.
+          */
+         void dispatchEvent(Event event, HandlerParams& params);
+
+         /**
+          * Does the real work of \c dispatchEvent(), regardless of deferred
+          * dispatch being enabled or not.
+          */
+         void deliverEvent(Event event, HandlerParams& params);
+
+         /**
+          * Stores an event in the deferred queue, growing it if necessary.
+          * @param event The event being queued.
+          * @param params The parameters that would be passed to the handlers.
+          */
+         void queueDeferredEvent(Event event, const HandlerParams& params);
+
+         /**
+          * Makes sure the deferred queue can hold at least \c capacity events
+          * without growing. Queued events are preserved.
+          */
+         void reserveDeferredEvents(std::size_t capacity);
+
+         /**
+          * Keeps track of the times \c latencyMonitor_ needs: the offset
+          * between the event clock and \c osg::Timer, and the time of the
+          * mouse motion the next \c FRAME will respond to.
+          * @param ea The event being handled.
+          */
+         void updateLatencyClock(const osgGA::GUIEventAdapter& ea);
+
+         /**
+          * Records, in \c latencyMonitor_, the latency of an event about to
+          * be delivered.
+          * @param event The event being delivered.
+          * @param params The parameters passed to the signal handlers.
+          */
+         void recordLatency(Event event, const HandlerParams& params);
 
          /**
           * Handles a \c FRAME event triggered by OSG. Signals triggered here
@@ -275,6 +939,77 @@ namespace OSGUIsh
          void handleFrameEvent(osg::View* view,
                                const osgGA::GUIEventAdapter& ea);
 
+         /**
+          * Picks at the coordinates of an event and triggers the
+          * <tt>"MouseEnter"</tt>, <tt>"MouseLeave"</tt> and
+          * <tt>"MouseMove"</tt> signals the change in the node under the mouse
+          * calls for.
+          * @param view The view displaying the scene.
+          * @param ea The event generated by OSG.
+          * @param motion The mouse positions to pass to the handlers (see \c
+          *        HandlerParams::motion).
+          */
+         void updateNodeUnderMouse(osg::View* view,
+                                   const osgGA::GUIEventAdapter& ea,
+                                   const MotionSamples_t* motion = 0);
+
+         /**
+          * Picks along the path followed by the mouse since the last pick,
+          * triggering <tt>"MouseEnter"</tt> and <tt>"MouseLeave"</tt> for the
+          * nodes crossed, and leaving \c nodeUnderMouse_ at the last one. See
+          * \c setSweptPicking().
+          * @param view The view displaying the scene.
+          * @param ea The event generated by OSG.
+          * @param motion The mouse positions since the last frame.
+          */
+         void sweepPick(osg::View* view, const osgGA::GUIEventAdapter& ea,
+                        const MotionSamples_t& motion);
+
+         /**
+          * Starts dragging \c nodeUnderMouse_, if it has a drag constraint.
+          * Triggers <tt>"DragStart"</tt>.
+          * @param view The view displaying the scene.
+          * @param ea The \c PUSH event generated by OSG.
+          */
+         void startDrag(osg::View* view, const osgGA::GUIEventAdapter& ea);
+
+         /**
+          * Projects the mouse position on the drag constraint, triggering
+          * <tt>"Drag"</tt> if the point changed.
+          * @param view The view displaying the scene.
+          * @param ea The event generated by OSG.
+          * @param motion The mouse positions to pass to the handlers (see \c
+          *        HandlerParams::motion).
+          */
+         void updateDrag(osg::View* view, const osgGA::GUIEventAdapter& ea,
+                         const MotionSamples_t* motion = 0);
+
+         /**
+          * Finishes the current drag, triggering <tt>"DragEnd"</tt>.
+          * @param view The view displaying the scene (may be \c NULL, in
+          *        which case the mouse position is not projected again).
+          * @param ea The \c RELEASE event generated by OSG.
+          */
+         void endDrag(osg::View* view, const osgGA::GUIEventAdapter& ea);
+
+         /**
+          * Projects a mouse position on the current drag constraint.
+          * @param view The view displaying the scene.
+          * @param ea The event with the mouse position.
+          * @param point The projected point is returned here.
+          * @return \c false if the projection is not defined (say, the mouse
+          *         ray is parallel to the drag plane).
+          */
+         bool projectOnDragConstraint(osg::View* view,
+                                      const osgGA::GUIEventAdapter& ea,
+                                      osg::Vec3d& point) const;
+
+         /**
+          * Adds the position of a \c MOVE or \c DRAG event to \c
+          * pendingMotion_.
+          */
+         void addMotionSample(const osgGA::GUIEventAdapter& ea);
+
          /**
           * Handles a \c PUSH event triggered by OSG. The only signal triggered
           * here is <tt>"MouseDown"</tt>, but this function also does
@@ -306,11 +1041,27 @@ namespace OSGUIsh
 
          /**
           * Handles a \c SCROLL event triggered by OSG. The signals triggered
-          * here are <tt>"ScrollUp"</tt> and <tt>"ScrollDown"</tt>.
+          * here are <tt>"ScrollUp"</tt> and <tt>"ScrollDown"</tt>; the
+          * motion is also accumulated for the next <tt>"MouseWheel"</tt>.
           * @param ea The event generated by OSG.
           */
          void handleScrollEvent(const osgGA::GUIEventAdapter& ea);
 
+         /**
+          * Adds some wheel motion to the one accumulated for the node with
+          * the mouse wheel focus.
+          * @param ea The \c SCROLL event generated by OSG.
+          * @param delta The wheel motion (see \c HandlerParams::wheelDelta).
+          */
+         void accumulateWheel(const osgGA::GUIEventAdapter& ea,
+                              const osg::Vec2& delta);
+
+         /**
+          * Triggers the <tt>"MouseWheel"</tt> events for the wheel motion
+          * accumulated since the previous frame.
+          */
+         void dispatchWheelEvents();
+
          /**
           * The "radius" of the picker. If zero, will use an \c
           * osgUtil::LineSegmentIntersector; if greater than zero, will use an
@@ -332,34 +1083,385 @@ namespace OSGUIsh
           */
          NodeMasks_t pickingMasks_;
 
+         /// Do \c PUSH and \c RELEASE events pick at their own coordinates?
+         bool pickOnButtonEvents_;
+
+         /**
+          * Everything a pick depends on, except for the scene itself and the
+          * picking masks (changing the masks invalidates it).
+          */
+         struct PickKey_t
+         {
+            PickKey_t(): valid(false) { }
+
+            /// Does this refer to an actual pick?
+            bool valid;
+
+            /// The view picked in.
+            const osg::View* view;
+
+            /// The frame number when picking.
+            unsigned frameNumber;
+
+            /// The window coordinates picked at.
+            float x, y;
+
+            /// The camera view matrix when picking.
+            osg::Matrixd viewMatrix;
+
+            /// The camera projection matrix when picking.
+            osg::Matrixd projectionMatrix;
+
+            /// The picker radius used.
+            double pickerRadius;
+
+            /// Were back faces ignored?
+            bool ignoreBackFaces;
+
+            /// Would picking with \c other find the same as with \c *this?
+            bool operator==(const PickKey_t& other) const
+            {
+               return valid && other.valid
+                  && view == other.view
+                  && frameNumber == other.frameNumber
+                  && x == other.x && y == other.y
+                  && viewMatrix == other.viewMatrix
+                  && projectionMatrix == other.projectionMatrix
+                  && pickerRadius == other.pickerRadius
+                  && ignoreBackFaces == other.ignoreBackFaces;
+            }
+         };
+
+         /**
+          * What the last pick depended on. If a new pick would depend on the
+          * same, its result is reused instead.
+          */
+         PickKey_t lastPickKey_;
+
          /**
-          * The values to be returned by the \c handle() method, depending on
-          * the event type it is handling. Currently, this is not initialized,
-          * meaning that \c handle(), by default, returns \c false for all event
-          * types.
-          * @todo Implement a method like \c setHandleReturnValue(), so that the
-          *        user can configure this.
+          * The event types for which \c handle() always returns \c true. Since
+          * <tt>osgGA::GUIEventAdapter::EventType</tt>s are bit flags, this is
+          * just a bitwise OR of them.
+          * @see setHandleReturnValue()
           */
-         std::map <osgGA::GUIEventAdapter::EventType, bool> handleReturnValues_;
+         unsigned handleReturnValues_;
+
+         /// The nodes whose events are always consumed.
+         std::set<osg::Node*> consumingNodes_;
+
+         /**
+          * Was the event currently being handled consumed by any node or
+          * handler?
+          */
+         bool eventConsumed_;
+
+         /**
+          * Was the last mouse button press consumed? If so, the drags and the
+          * release that follow are consumed, too.
+          */
+         bool mouseDownConsumed_;
+
+         /**
+          * Checks whether an event delivered with the given parameters was
+          * consumed, and updates \c eventConsumed_ accordingly.
+          */
+         void updateEventConsumed(const HandlerParams& params);
 
          /// Type mapping an event type to the signal object.
          typedef std::map <Event, SignalPtr> SignalCollection_t;
 
-         /// Type mapping nodes to the collection of signals associated to it.
-         typedef std::map <NodePtr, SignalCollection_t > SignalsMap_t;
+         /// Hashes a \c NodePtr, using the address of the node.
+         struct NodePtrHash_t
+         {
+            std::size_t operator()(const NodePtr& node) const
+            { return boost::hash<osg::Node*>()(node.get()); }
+         };
 
          /**
-          * Structure containing all the signals used by this \c EventHandler.
-          * It can be used with a syntax like this:
-          * <tt>signals_[node][EVENT_MOUSE_MOVE]->connect(&MyHandler);</tt>
+          * Type mapping nodes to the collection of signals associated to it.
+          * This is a hash table because it is looked up for every node in the
+          * path of every hit (see \c getObservedNode()).
+          */
+         typedef boost::unordered_map<NodePtr, SignalCollection_t,
+                                      NodePtrHash_t> SignalsMap_t;
+
+         /**
+          * Structure containing all the per-node signals used by this \c
+          * EventHandler. Every registered node has an entry here, but the
+          * signals themselves are created on demand, by \c getSignal().
           */
          SignalsMap_t signals_;
 
          /**
-          * The \c Intersection_t structure for the node currently under the
-          * mouse pointer. (Respecting the \c ignoreBackFaces_ flag.)
+          * The handler-wide signals, indexed by \c Event.
+          * @see getGlobalSignal()
+          */
+         SignalPtr globalSignals_[EVENT_COUNT];
+
+         /**
+          * The capture-phase signals. Like \c signals_, these are created on
+          * demand; unlike \c signals_, nodes get an entry here only when a
+          * capture signal is requested for them.
+          */
+         SignalsMap_t captureSignals_;
+
+         /// A key binding: what a key signal is associated to.
+         struct KeyBinding_t
+         {
+            /// The node (\c NULL for the global bindings).
+            const osg::Node* node;
+
+            /// Either \c EVENT_KEY_DOWN or \c EVENT_KEY_UP.
+            Event event;
+
+            /// The key.
+            int key;
+
+            /// The modifier keys (normalized).
+            unsigned modKeyMask;
+
+            bool operator==(const KeyBinding_t& other) const
+            {
+               return node == other.node && event == other.event
+                  && key == other.key && modKeyMask == other.modKeyMask;
+            }
+         };
+
+         /// Hashes a \c KeyBinding_t.
+         struct KeyBindingHash_t
+         {
+            std::size_t operator()(const KeyBinding_t& binding) const
+            {
+               std::size_t seed = 0;
+               boost::hash_combine(seed, binding.node);
+               boost::hash_combine(seed, static_cast<int>(binding.event));
+               boost::hash_combine(seed, binding.key);
+               boost::hash_combine(seed, binding.modKeyMask);
+               return seed;
+            }
+         };
+
+         /// Type mapping key bindings to their signals.
+         typedef boost::unordered_map<KeyBinding_t, SignalPtr,
+                                      KeyBindingHash_t> KeySignalsMap_t;
+
+         /**
+          * The key signals of all nodes, plus the global ones. Created on
+          * demand, by \c getKeySignal() and \c getGlobalKeySignal().
+          */
+         KeySignalsMap_t keySignals_;
+
+         /// Is DOM-like event propagation enabled?
+         bool eventPropagation_;
+
+         /**
+          * The \c WorkerPool running asynchronous handlers. Created on demand,
+          * so that no threads are started if nobody uses them.
+          */
+         WorkerPoolPtr workerPool_;
+
+         /**
+          * The tasks posted to the main thread by asynchronous handlers, run
+          * at every frame. Shared by all the pools ever used, so that
+          * changing the pool doesn't strand any results.
+          */
+         MainThreadQueuePtr mainThreadQueue_;
+
+         /// The profiler timing the handlers (if any).
+         HandlerProfilerPtr profiler_;
+
+         /// Were picking statistics explicitly enabled?
+         bool collectPickingStats_;
+
+         /// Are picking statistics being collected in the current frame?
+         bool collectingPickingStats_;
+
+         /// The picking statistics being collected for the current frame.
+         PickingStats pickingStats_;
+
+         /// The picking statistics collected for the last frame.
+         PickingStats lastPickingStats_;
+
+         /// The recorder recording the events (if any).
+         EventRecorderPtr recorder_;
+
+         /**
+          * An event waiting in the deferred queue: everything needed to
+          * rebuild its \c HandlerParams later.
+          */
+         struct DeferredEvent_t
+         {
+            /// The event itself.
+            Event event;
+
+            /// The node the event is targeted at.
+            NodePtr target;
+
+            /// The OSG event that generated it.
+            osg::ref_ptr<const osgGA::GUIEventAdapter> ea;
+
+            /// The hit under the mouse when the event was generated.
+            Intersection_t hit;
+
+            /// Are the handlers passed \c motion?
+            bool hasMotion;
+
+            /**
+             * A copy of the mouse positions passed to the handlers. (A copy,
+             * because \c frameMotion_ may be reused before the event is
+             * dispatched.)
+             */
+            MotionSamples_t motion;
+
+            /// Are the handlers passed \c drag?
+            bool hasDrag;
+
+            /// A copy of the drag state passed to the handlers.
+            DragInfo_t drag;
+
+            /// The wheel motion passed to the handlers.
+            osg::Vec2 wheelDelta;
+         };
+
+         /// Is deferred dispatch enabled?
+         bool deferredDispatch_;
+
+         /**
+          * The deferred queue, used as a ring buffer. Its slots are reused, so
+          * that queuing an event doesn't allocate memory once the queue is
+          * warmed up.
+          */
+         std::vector<DeferredEvent_t> deferredEvents_;
+
+         /// The index, in \c deferredEvents_, of the oldest queued event.
+         std::size_t deferredHead_;
+
+         /// The number of events in \c deferredEvents_.
+         std::size_t deferredCount_;
+
+         /**
+          * The intersection for the node currently under the mouse pointer.
+          * (Respecting the \c ignoreBackFaces_ flag.) This refers to data
+          * owned by \c hitIntersector_.
+          */
+         IntersectionView_t hitUnderMouse_;
+
+         /**
+          * The intersector holding the data \c hitUnderMouse_ refers to. This
+          * is one of \c lineIntersectors_ or \c polytopeIntersectors_.
+          */
+         osg::ref_ptr<osgUtil::Intersector> hitIntersector_;
+
+         /**
+          * The intersectors used for picking with a line segment. They are
+          * created once and reused, so that picking doesn't allocate new ones
+          * at every frame. There are two of them, used alternately: picking
+          * always uses the one \c hitUnderMouse_ doesn't refer to, so that
+          * the data of the last hit remains valid even if nothing is hit.
+          */
+         osg::ref_ptr<osgUtil::LineSegmentIntersector> lineIntersectors_[2];
+
+         /**
+          * The intersectors used for picking with a polytope. Used just like
+          * \c lineIntersectors_.
+          */
+         osg::ref_ptr<osgUtil::PolytopeIntersector> polytopeIntersectors_[2];
+
+         /// The visitor used for picking, reused for the same reason.
+         osg::ref_ptr<osgUtil::IntersectionVisitor> pickVisitor_;
+
+         /**
+          * The roots of the subtrees ignored when picking. This is a hash
+          * table because it is looked up for every node visited by the
+          * picking traversal (when not empty).
+          */
+         boost::unordered_set<const osg::Node*> pickExclusions_;
+
+         /// The number of allocations made in the last call to \c handle().
+         std::size_t lastHandleAllocations_;
+
+         /// The tracer recording spans of time (if any).
+         TracerPtr tracer_;
+
+         /// The mouse positions reported since the last \c FRAME.
+         MotionSamples_t pendingMotion_;
+
+         /// The mouse positions reported before the last \c FRAME.
+         MotionSamples_t frameMotion_;
+
+         /// The maximum number of elements in \c pendingMotion_.
+         std::size_t maxMotionSamples_;
+
+         /// Is swept picking enabled?
+         bool sweptPicking_;
+
+         /// The distance, in pixels, between points picked when sweeping.
+         float sweepPixelStep_;
+
+         /// The maximum number of points picked when sweeping, per frame.
+         std::size_t maxSweepSamples_;
+
+         /**
+          * The index, in \c pendingMotion_, of the first position not picked
+          * yet. (Picking at \c PUSH and \c RELEASE picks the positions
+          * before them.)
+          */
+         std::size_t pendingSweepStart_;
+
+         /// The value \c pendingSweepStart_ had at the last \c FRAME.
+         std::size_t frameSweepStart_;
+
+         /**
+          * The intersectors used when sweeping with a line segment, one per
+          * point.
+          */
+         std::vector< osg::ref_ptr<osgUtil::LineSegmentIntersector> >
+            sweepLineIntersectors_;
+
+         /**
+          * The intersectors used when sweeping with a polytope, one per
+          * point.
+          */
+         std::vector< osg::ref_ptr<osgUtil::PolytopeIntersector> >
+            sweepPolytopeIntersectors_;
+
+         /// The group of intersectors passed to the visitor when sweeping.
+         osg::ref_ptr<osgUtil::IntersectorGroup> sweepGroup_;
+
+         /// The path being swept, in window coordinates.
+         std::vector<osg::Vec2> sweepPath_;
+
+         /// The node found at each point swept.
+         std::vector<NodePtr> sweepNodes_;
+
+         /// The hit found at each point swept (invalid if none).
+         std::vector<IntersectionView_t> sweepHits_;
+
+         /// The monitor collecting input-to-dispatch latencies (if any).
+         LatencyMonitorPtr latencyMonitor_;
+
+         /**
+          * The value to add to <tt>osgGA::GUIEventAdapter::getTime()</tt> to
+          * get a time comparable to <tt>osg::Timer::time_s()</tt>. Valid only
+          * if \c eventClockSynced_ is \c true.
           */
-         Intersection_t hitUnderMouse_;
+         double eventClockOffset_;
+
+         /// Was \c eventClockOffset_ computed already?
+         bool eventClockSynced_;
+
+         /**
+          * The time of the first mouse motion since the last \c FRAME, or a
+          * negative number if there was no motion.
+          */
+         double pendingMotionTime_;
+
+         /**
+          * The time of the first mouse motion before the last \c FRAME, or a
+          * negative number if there was no motion. Hover events are generated
+          * in response to it.
+          */
+         double frameMotionTime_;
 
          //
          // For "MouseEnter", "MouseLeave", "MouseMove"
@@ -402,6 +1504,21 @@ namespace OSGUIsh
           */
          MouseButton getMouseButton(const osgGA::GUIEventAdapter& ea);
 
+         /**
+          * Does the work of \c getObservedNode().
+          * @param nodePath The node path leading to the node being queried.
+          * @param numLookups Returns the number of registered node lookups
+          *        done.
+          */
+         NodePtr findObservedNode(const osg::NodePath& nodePath,
+                                  std::size_t& numLookups) const;
+
+         /**
+          * The version of \c getObservedNode() used when picking, which also
+          * updates the picking statistics and the trace.
+          */
+         NodePtr lookupObservedNode(const osg::NodePath& nodePath);
+
          /**
           * Updates the member variables used to store picking info: \c
           * nodeUnderMouse_, \c positionUnderMouse_, \c prevNodeUnderMouse_ and
@@ -423,24 +1540,24 @@ namespace OSGUIsh
           * The version of \c updatePickingData() using an \c
           * osgUtil::LineSegmentIntersector.
           * @param view The view displaying the scene.
-          * @param ea The event generated by OSG.
+          * @param x The horizontal window coordinate to pick at.
+          * @param y The vertical window coordinate to pick at.
           * @see updatePickingData() for information on what this function does.
           */
-         void updatePickingDataLine(osg::View* view,
-                                    const osgGA::GUIEventAdapter& ea);
+         void updatePickingDataLine(osg::View* view, float x, float y);
 
          /**
           * The version of \c updatePickingData() using an \c
           * osgUtil::PolytopeIntersector.
           * @param view The view displaying the scene.
-          * @param ea The event generated by OSG.
+          * @param x The horizontal window coordinate to pick at.
+          * @param y The vertical window coordinate to pick at.
           * @see updatePickingData() for information on what this function does.
           * @note This function does not even try to ignore back faces when
           *       <tt>ignoreBackFaces_ == true</tt> (the \c PolytopeIntersector
           *       does not provide the intersection normals).
           */
-         void updatePickingDataPolytope(osg::View* view,
-                                        const osgGA::GUIEventAdapter& ea);
+         void updatePickingDataPolytope(osg::View* view, float x, float y);
 
          /**
           * An array indicating (for every mouse button) which was the node that
@@ -481,6 +1598,72 @@ namespace OSGUIsh
 
          /// The focus policy for mouse wheel-related events.
          FocusPolicyPtr wheelFocusPolicy_;
+
+         /// The wheel motion accumulated for a node since the previous frame.
+         struct WheelMotion_t
+         {
+            /// The node with the wheel focus.
+            NodePtr node;
+
+            /// The accumulated motion.
+            osg::Vec2 delta;
+
+            /// The last \c SCROLL event accumulated.
+            osg::ref_ptr<const osgGA::GUIEventAdapter> ea;
+         };
+
+         /**
+          * The wheel motion accumulated since the previous frame, one entry
+          * per node that had the wheel focus meanwhile (normally, just one).
+          */
+         std::vector<WheelMotion_t> pendingWheel_;
+
+         /// The scrolling delta equivalent to one wheel notch.
+         float wheelNotch_;
+
+         /**
+          * The vertical smooth-scrolling delta not yet converted to
+          * <tt>"MouseWheelUp"</tt> and <tt>"MouseWheelDown"</tt> events.
+          */
+         float wheelResidual_;
+
+         /// The node \c wheelResidual_ refers to.
+         NodePtr wheelResidualNode_;
+
+         //
+         // For "DragStart", "Drag" and "DragEnd"
+         //
+
+         /// A map from nodes to their drag constraints.
+         typedef boost::unordered_map<
+            NodePtr, DragConstraint_t, NodePtrHash_t> DragConstraints_t;
+
+         /// The drag constraints of the draggable nodes.
+         DragConstraints_t dragConstraints_;
+
+         /// The node being dragged (the one capturing the mouse), if any.
+         NodePtr dragNode_;
+
+         /// The mouse button that started the current drag.
+         MouseButton dragButton_;
+
+         /**
+          * The constraint of the current drag, with the normal or direction
+          * normalized (and computed, for \c VIEW_PLANE).
+          */
+         DragConstraint_t dragConstraint_;
+
+         /// The state of the current drag.
+         DragInfo_t dragInfo_;
+
+         /// The hit when the current drag started.
+         Intersection_t dragHit_;
+
+         /// Has the dragged point changed since the drag started?
+         bool dragMoved_;
+
+         /// Does picking go on while a node is dragged?
+         bool pickWhileDragging_;
    };
 
 } // namespace OSGUIsh
@@ -0,0 +1,98 @@
+/******************************************************************************\
+* EventRecorder.hpp                                                            *
+* Records the stream of events seen by an EventHandler to a file.              *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#ifndef _OSGUISH_EVENT_RECORDER_HPP_
+#define _OSGUISH_EVENT_RECORDER_HPP_
+
+#include <fstream>
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <boost/cstdint.hpp>
+#include <osgGA/GUIEventAdapter>
+#include <osg/View>
+
+
+namespace OSGUIsh
+{
+   /**
+    * Records the \c osgGA::GUIEventAdapter stream seen by an \c EventHandler
+    * into a compact binary file, which can be fed back later with an \c
+    * EventReplayer. This makes hover and click problems (which usually
+    * depend on exact mouse paths and timing) reproducible.
+    *
+    * For every \c FRAME event, the camera view and projection matrices, the
+    * viewport and the window input range are recorded too, so that picking
+    * gives the same results on replay. Other events store only the fields
+    * meaningful for their type.
+    *
+    * Data is written in the native byte order; the file header allows the
+    * \c EventReplayer to detect (and refuse) files written with a different
+    * one.
+    *
+    * @see EventHandler::setEventRecorder()
+    */
+   class EventRecorder
+   {
+      public:
+         /// The magic bytes starting every recording.
+         static const char FILE_MAGIC[8];
+
+         /// The version of the file format.
+         static const boost::uint32_t FILE_VERSION = 1;
+
+         /**
+          * Constructs the \c EventRecorder, creating (or truncating) a file
+          * and writing the file header.
+          * @param fileName The file to write.
+          */
+         EventRecorder(const std::string& fileName);
+
+         /// Is the output file fine?
+         bool isValid() const { return file_.good(); }
+
+         /**
+          * Records an event.
+          * @param ea The event.
+          * @param view The view where the event happened. Used only for \c
+          *        FRAME events, to record the camera state. May be \c NULL,
+          *        in which case identity matrices are written.
+          */
+         void record(const osgGA::GUIEventAdapter& ea, const osg::View* view);
+
+         /// Writes any buffered data to the file.
+         void flush() { file_.flush(); }
+
+         /// Returns the number of events recorded so far.
+         std::size_t getNumEvents() const { return numEvents_; }
+
+      private:
+         /// Writes a value, as raw bytes.
+         template <class T>
+         void write(const T& value)
+         {
+            file_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+         }
+
+         /// The output file.
+         std::ofstream file_;
+
+         /// The number of events recorded so far.
+         std::size_t numEvents_;
+   };
+
+
+
+   /// A (smart) pointer to an \c EventRecorder.
+   typedef boost::shared_ptr<EventRecorder> EventRecorderPtr;
+
+} // namespace OSGUIsh
+
+#endif // _OSGUISH_EVENT_RECORDER_HPP_
@@ -0,0 +1,110 @@
+/******************************************************************************\
+* EventReplayer.hpp                                                            *
+* Feeds events recorded by an EventRecorder back to an event handler.          *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#ifndef _OSGUISH_EVENT_REPLAYER_HPP_
+#define _OSGUISH_EVENT_REPLAYER_HPP_
+
+#include <fstream>
+#include <string>
+#include <osgGA/GUIActionAdapter>
+#include <osgGA/GUIEventAdapter>
+#include <osgGA/GUIEventHandler>
+#include <osg/Matrixd>
+#include <osg/View>
+
+
+namespace OSGUIsh
+{
+   /**
+    * Reads a file written by an \c EventRecorder, and feeds the events back
+    * to an event handler, under virtual time: events keep their recorded
+    * timestamps, and are delivered as fast as the handler can take them.
+    * Before every \c FRAME event, the recorded camera state is restored, so
+    * that picking sees exactly what it saw when recording.
+    */
+   class EventReplayer
+   {
+      public:
+         /**
+          * Constructs the \c EventReplayer, opening a file and checking its
+          * header.
+          * @param fileName The file to read.
+          */
+         EventReplayer(const std::string& fileName);
+
+         /**
+          * Is the input file fine? This is \c false if the file couldn't be
+          * opened or is not a recording this version can read (including
+          * recordings made with a different byte order).
+          */
+         bool isValid() const { return valid_; }
+
+         /**
+          * Reads the next event from the file.
+          * @return \c false at the end of the file (or on errors).
+          */
+         bool readEvent();
+
+         /// Returns the last event read.
+         osgGA::GUIEventAdapter& getEvent() { return *event_; }
+
+         /**
+          * Restores the camera state recorded with the last \c FRAME event
+          * read: view and projection matrices, and the viewport.
+          */
+         void applyCameraState(osg::View& view) const;
+
+         /**
+          * Replays all the remaining events.
+          * @param handler The handler receiving the events.
+          * @param view The view used to restore the camera state. Its frame
+          *        stamp (if any) is also advanced at every \c FRAME event.
+          * @param aa The action adapter passed to \c handler. Note that the
+          *        \c EventHandler expects this to be \c view itself.
+          * @return The number of events replayed.
+          */
+         std::size_t replay(osgGA::GUIEventHandler& handler, osg::View& view,
+                            osgGA::GUIActionAdapter& aa);
+
+      private:
+         /// Reads a value, as raw bytes.
+         template <class T>
+         void read(T& value)
+         {
+            file_.read(reinterpret_cast<char*>(&value), sizeof(T));
+         }
+
+         /// The input file.
+         std::ifstream file_;
+
+         /// Is the file valid?
+         bool valid_;
+
+         /**
+          * The last event read. Since some of its state (like the window input
+          * range) is stored only with \c FRAME events, every event is created
+          * as a copy of the previous one.
+          */
+         osg::ref_ptr<osgGA::GUIEventAdapter> event_;
+
+         /// The view matrix recorded with the last \c FRAME event.
+         osg::Matrixd viewMatrix_;
+
+         /// The projection matrix recorded with the last \c FRAME event.
+         osg::Matrixd projectionMatrix_;
+
+         /// The viewport recorded with the last \c FRAME event (x, y, w, h).
+         double viewport_[4];
+   };
+
+} // namespace OSGUIsh
+
+#endif // _OSGUISH_EVENT_REPLAYER_HPP_
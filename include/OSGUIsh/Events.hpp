@@ -94,8 +94,93 @@ namespace OSGUIsh
        * focus.
        */
       EVENT_MOUSE_WHEEL_DOWN,
+
+      /**
+       * A "drag start" event; generated right after the \c EVENT_MOUSE_DOWN
+       * on a registered node that has a drag constraint (see \c
+       * EventHandler::setDragConstraint()). The node then captures the
+       * mouse until the button is released.
+       */
+      EVENT_DRAG_START,
+
+      /**
+       * A "drag" event; generated at most once per frame while a node
+       * captures the mouse, when the mouse position projected on the drag
+       * constraint changes.
+       */
+      EVENT_DRAG,
+
+      /**
+       * A "drag end" event; generated when the mouse button that started a
+       * drag is released, just before the \c EVENT_MOUSE_UP.
+       */
+      EVENT_DRAG_END,
+
+      /**
+       * A "mouse wheel" event; generated at most once per frame for the node
+       * with the mouse wheel focus, with the sum of all the wheel motion
+       * (vertical and horizontal, including the fractional deltas of
+       * smooth-scrolling devices) since the previous frame. See \c
+       * HandlerParams::wheelDelta. \c EVENT_MOUSE_WHEEL_UP and \c
+       * EVENT_MOUSE_WHEEL_DOWN are still generated, as they always were.
+       */
+      EVENT_MOUSE_WHEEL,
+
+      /// The number of events supported by OSGUIsh (not an event itself).
+      EVENT_COUNT
+   };
+
+
+
+   /**
+    * The phases an event goes through when event propagation is enabled (see
+    * \c EventHandler::setEventPropagation()). This follows the DOM model:
+    * first the event travels from the root of the node path down to the
+    * target node (capture), then it is delivered to the target itself, and
+    * finally it travels back up to the root (bubble). Only registered nodes
+    * along the path receive the event.
+    */
+   enum EventPhase
+   {
+      /// The event is going down from an ancestor towards the target.
+      PHASE_CAPTURE,
+
+      /// The event is being delivered to the target node itself.
+      PHASE_TARGET,
+
+      /// The event is going up from the target towards the root.
+      PHASE_BUBBLE
    };
 
+
+
+   /**
+    * Returns a human-readable name for an event, like \c "MouseEnter". Useful
+    * for logging and reports.
+    */
+   inline const char* GetEventName(Event event)
+   {
+      switch (event)
+      {
+         case EVENT_MOUSE_MOVE: return "MouseMove";
+         case EVENT_MOUSE_ENTER: return "MouseEnter";
+         case EVENT_MOUSE_LEAVE: return "MouseLeave";
+         case EVENT_MOUSE_DOWN: return "MouseDown";
+         case EVENT_MOUSE_UP: return "MouseUp";
+         case EVENT_CLICK: return "Click";
+         case EVENT_DOUBLE_CLICK: return "DoubleClick";
+         case EVENT_KEY_DOWN: return "KeyDown";
+         case EVENT_KEY_UP: return "KeyUp";
+         case EVENT_MOUSE_WHEEL_UP: return "MouseWheelUp";
+         case EVENT_MOUSE_WHEEL_DOWN: return "MouseWheelDown";
+         case EVENT_DRAG_START: return "DragStart";
+         case EVENT_DRAG: return "Drag";
+         case EVENT_DRAG_END: return "DragEnd";
+         case EVENT_MOUSE_WHEEL: return "MouseWheel";
+         default: return "Unknown";
+      }
+   }
+
 } // namespace OSGUIsh
 
 #endif // _OSGUISH_EVENTS_HPP_
@@ -41,13 +41,20 @@ namespace OSGUIsh
           * signals are called.
           * @param ea The event generated by OSG.
           * @param nodeUnderMouse The node under the mouse pointer.
+          * @note Up to OSGUIsh 0.3, \c nodeUnderMouse was taken by value.
+          *       Custom policies overriding this must take it as a <tt>const
+          *       NodePtr&</tt> now; with the old signature, their \c
+          *       updateFocus() is an unrelated overload that is never called.
           */
          virtual void updateFocus(const osgGA::GUIEventAdapter& ea,
-                                  const NodePtr nodeUnderMouse) = 0;
+                                  const NodePtr& nodeUnderMouse) = 0;
 
       protected:
+         /// Returns the focused node.
+         const NodePtr& getFocusedNode() const { return focusedNode_; }
+
          /// Updates the focused node.
-         void setFocusedNode(NodePtr focusedNode)
+         void setFocusedNode(const NodePtr& focusedNode)
          { focusedNode_ = focusedNode; }
 
       private:
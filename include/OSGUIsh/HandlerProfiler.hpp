@@ -0,0 +1,141 @@
+/******************************************************************************\
+* HandlerProfiler.hpp                                                          *
+* Measures how long event handlers take to run.                                *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#ifndef _OSGUISH_HANDLER_PROFILER_HPP_
+#define _OSGUISH_HANDLER_PROFILER_HPP_
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <osg/observer_ptr>
+#include <OSGUIsh/Events.hpp>
+#include <OSGUIsh/Histogram.hpp>
+#include <OSGUIsh/Types.hpp>
+
+
+namespace OSGUIsh
+{
+   /**
+    * Collects the time spent running event handlers, as histograms keyed by
+    * node name and \c Event. Once set with \c EventHandler::setProfiler(),
+    * every signal invocation is timed (the time includes all handlers
+    * connected to the node's signal and to the global signal).
+    *
+    * The profiler can also report slow handlers as they happen: see \c
+    * setSlowThreshold().
+    */
+   class HandlerProfiler
+   {
+      public:
+         /**
+          * A function called when a handler is slower than the threshold.
+          * Parameters are the node, the event, and the time taken, in seconds.
+          */
+         typedef boost::function<void (const NodePtr&, Event, double)>
+            SlowHandlerCallback_t;
+
+         /// Constructs a \c HandlerProfiler, with no slow handler threshold.
+         HandlerProfiler();
+
+         /**
+          * Records the time taken to handle an event.
+          * @param node The node that got the event.
+          * @param event The event.
+          * @param seconds The time taken by the handlers.
+          */
+         void record(const NodePtr& node, Event event, double seconds);
+
+         /**
+          * Returns the histogram for a given node name and event, or \c NULL if
+          * no such event was recorded.
+          */
+         const Histogram* getHistogram(const std::string& nodeName,
+                                       Event event) const;
+
+         /**
+          * Sets the slow handler threshold. Whenever the handlers for an event
+          * take longer than this, the slow handler callback is called (by
+          * default, a warning is written through \c osg::notify()).
+          * @param seconds The threshold, in seconds. Zero (the default)
+          *        disables the reports.
+          */
+         void setSlowThreshold(double seconds) { slowThreshold_ = seconds; }
+
+         /// Sets the function called to report slow handlers.
+         void setSlowHandlerCallback(const SlowHandlerCallback_t& callback)
+         { slowHandlerCallback_ = callback; }
+
+         /**
+          * Writes all the collected data in CSV format: one line per node name
+          * and event, with summary statistics (in milliseconds) followed by the
+          * histogram bucket counts.
+          */
+         void writeCSV(std::ostream& os) const;
+
+         /**
+          * Writes all the collected data in CSV format to a file.
+          * @return \c true on success.
+          */
+         bool writeCSV(const std::string& fileName) const;
+
+         /// Discards all the collected data.
+         void clear();
+
+      private:
+         /// The histograms of one node name, indexed by \c Event.
+         struct NodeHistograms_t
+         {
+            Histogram byEvent[EVENT_COUNT];
+         };
+
+         /// Returns the name used for a given node in reports.
+         static std::string getNodeName(const NodePtr& node);
+
+         /// The histograms, keyed by node name.
+         std::map<std::string, NodeHistograms_t> histograms_;
+
+         /// An entry in \c nodeCache_.
+         struct CachedNode_t
+         {
+            /**
+             * The node. When it is deleted, this becomes \c NULL, so that a
+             * new node allocated at the same address is not mistaken for it.
+             */
+            osg::observer_ptr<osg::Node> node;
+
+            /// The entry in \c histograms_ for the node.
+            NodeHistograms_t* histograms;
+         };
+
+         /**
+          * A cache mapping nodes to their entries in \c histograms_, so that
+          * recording doesn't need to compare strings.
+          * @note As a consequence, node names are read just once per node.
+          */
+         std::map<const osg::Node*, CachedNode_t> nodeCache_;
+
+         /// The slow handler threshold, in seconds (zero if disabled).
+         double slowThreshold_;
+
+         /// The function called to report slow handlers.
+         SlowHandlerCallback_t slowHandlerCallback_;
+   };
+
+
+
+   /// A (smart) pointer to a \c HandlerProfiler.
+   typedef boost::shared_ptr<HandlerProfiler> HandlerProfilerPtr;
+
+} // namespace OSGUIsh
+
+#endif // _OSGUISH_HANDLER_PROFILER_HPP_
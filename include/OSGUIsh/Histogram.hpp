@@ -0,0 +1,97 @@
+/******************************************************************************\
+* Histogram.hpp                                                                *
+* A log-bucketed histogram of durations.                                       *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#ifndef _OSGUISH_HISTOGRAM_HPP_
+#define _OSGUISH_HISTOGRAM_HPP_
+
+#include <cstddef>
+
+
+namespace OSGUIsh
+{
+   /**
+    * A histogram of durations, with logarithmic buckets: bucket \c i counts
+    * the samples in the range [2<sup>i</sup>, 2<sup>i+1</sup>) microseconds
+    * (bucket zero also counts anything under one microsecond, and the last
+    * bucket counts anything longer than its lower bound). Adding a sample is
+    * cheap and never allocates memory, so this can be used in the frame path.
+    */
+   class Histogram
+   {
+      public:
+         /// The number of buckets.
+         static const std::size_t NUM_BUCKETS = 32;
+
+         /// Constructs an empty \c Histogram.
+         Histogram();
+
+         /**
+          * Adds a sample to the histogram.
+          * @param seconds The sample, in seconds.
+          */
+         void add(double seconds);
+
+         /// Removes all samples.
+         void clear();
+
+         /// Returns the number of samples.
+         std::size_t getCount() const { return count_; }
+
+         /// Returns the sum of all samples, in seconds.
+         double getTotal() const { return total_; }
+
+         /// Returns the smallest sample, in seconds (zero if empty).
+         double getMin() const { return count_ > 0 ? min_ : 0.0; }
+
+         /// Returns the largest sample, in seconds (zero if empty).
+         double getMax() const { return max_; }
+
+         /// Returns the mean of the samples, in seconds (zero if empty).
+         double getMean() const
+         { return count_ > 0 ? total_ / count_ : 0.0; }
+
+         /**
+          * Returns an estimate of a given percentile of the samples, in
+          * seconds. Since only bucket counts are stored, this is the upper
+          * bound of the bucket where the percentile falls (clamped to the
+          * largest sample), so it errs on the pessimistic side by less than a
+          * factor of two.
+          * @param percentile The desired percentile, in the [0, 100] range.
+          */
+         double getPercentile(double percentile) const;
+
+         /// Returns the number of samples in a given bucket.
+         std::size_t getBucketCount(std::size_t bucket) const
+         { return buckets_[bucket]; }
+
+         /// Returns the upper bound of a given bucket, in seconds.
+         static double getBucketUpperBound(std::size_t bucket);
+
+      private:
+         /// The sample counts, per bucket.
+         std::size_t buckets_[NUM_BUCKETS];
+
+         /// The number of samples.
+         std::size_t count_;
+
+         /// The sum of all samples.
+         double total_;
+
+         /// The smallest sample.
+         double min_;
+
+         /// The largest sample.
+         double max_;
+   };
+
+} // namespace OSGUIsh
+
+#endif // _OSGUISH_HISTOGRAM_HPP_
@@ -0,0 +1,83 @@
+/******************************************************************************\
+* LatencyMonitor.hpp                                                           *
+* Measures the latency between input events and their handling.               *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#ifndef _OSGUISH_LATENCY_MONITOR_HPP_
+#define _OSGUISH_LATENCY_MONITOR_HPP_
+
+#include <iosfwd>
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <OSGUIsh/Events.hpp>
+#include <OSGUIsh/Histogram.hpp>
+
+
+namespace OSGUIsh
+{
+   /**
+    * Collects the input-to-dispatch latency of OSGUIsh events: the time
+    * between the arrival of the input event that caused an OSGUIsh event
+    * (as given by \c osgGA::GUIEventAdapter::getTime()) and the moment its
+    * handlers start to run. Once set with \c
+    * EventHandler::setLatencyMonitor(), one sample is recorded for every
+    * event dispatched.
+    *
+    * For <tt>"MouseEnter"</tt>, <tt>"MouseLeave"</tt>, <tt>"MouseMove"</tt>
+    * and <tt>"Drag"</tt>, which are only resolved at the next frame, the
+    * input event is the first mouse motion since the previous frame. So,
+    * these latencies include the wait for the frame, and their distribution
+    * reads as the worst case. <tt>"MouseWheel"</tt> also waits for the next
+    * frame, but is measured from the last wheel motion.
+    */
+   class LatencyMonitor
+   {
+      public:
+         /**
+          * Records the latency of an event.
+          * @param event The event.
+          * @param seconds The latency, in seconds.
+          */
+         void record(Event event, double seconds)
+         { histograms_[event].add(seconds); }
+
+         /// Returns the latency histogram for a given event.
+         const Histogram& getHistogram(Event event) const
+         { return histograms_[event]; }
+
+         /**
+          * Writes all the collected data in CSV format: one line per event,
+          * with summary statistics (in milliseconds) followed by the bucket
+          * counts.
+          */
+         void writeCSV(std::ostream& os) const;
+
+         /**
+          * Writes all the collected data to a file in CSV format (see the
+          * other overload).
+          * @return \c true on success, \c false otherwise.
+          */
+         bool writeCSV(const std::string& fileName) const;
+
+         /// Discards all the collected data.
+         void clear();
+
+      private:
+         /// The latency histograms, indexed by \c Event.
+         Histogram histograms_[EVENT_COUNT];
+   };
+
+
+
+   /// A (smart) pointer to a \c LatencyMonitor.
+   typedef boost::shared_ptr<LatencyMonitor> LatencyMonitorPtr;
+
+} // namespace OSGUIsh
+
+#endif // _OSGUISH_LATENCY_MONITOR_HPP_
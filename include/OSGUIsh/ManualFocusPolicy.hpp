@@ -25,11 +25,16 @@ namespace OSGUIsh
    {
       public:
          /// Constructs a \c ManualFocusPolicy.
-         ManualFocusPolicy(NodePtr& focusedNode);
+         ManualFocusPolicy(NodePtr& focusedNode)
+            : FocusPolicy(focusedNode)
+         { }
 
          // (inherits documentation)
-         virtual void updateFocus(const osgGA::GUIEventAdapter& ea,
-                                  const NodePtr nodeUnderMouse);
+         virtual void updateFocus(const osgGA::GUIEventAdapter&,
+                                  const NodePtr&)
+         {
+            // Do nothing. That's what "manual" is about.
+         }
    };
 
 } // namespace OSGUIsh
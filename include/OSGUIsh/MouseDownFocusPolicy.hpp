@@ -25,11 +25,17 @@ namespace OSGUIsh
    {
       public:
          /// Constructs a \c MouseDownFocusPolicy.
-         MouseDownFocusPolicy(NodePtr& focusedNode);
+         MouseDownFocusPolicy(NodePtr& focusedNode)
+            : FocusPolicy(focusedNode)
+         { }
 
          // (inherits documentation)
          virtual void updateFocus(const osgGA::GUIEventAdapter& ea,
-                                  const NodePtr nodeUnderMouse);
+                                  const NodePtr& nodeUnderMouse)
+         {
+            if (ea.getEventType() == osgGA::GUIEventAdapter::PUSH)
+               setFocusedNode(nodeUnderMouse);
+         }
    };
 
 } // namespace OSGUIsh
@@ -22,11 +22,14 @@ namespace OSGUIsh
    {
       public:
          /// Constructs a \c MouseOverFocusPolicy.
-         MouseOverFocusPolicy(NodePtr& focusedNode);
+         MouseOverFocusPolicy(NodePtr& focusedNode)
+            : FocusPolicy(focusedNode)
+         { }
 
          // (inherits documentation)
-         virtual void updateFocus(const osgGA::GUIEventAdapter& ea,
-                                  const NodePtr nodeUnderMouse);
+         virtual void updateFocus(const osgGA::GUIEventAdapter&,
+                                  const NodePtr& nodeUnderMouse)
+         { setFocusedNode(nodeUnderMouse); }
    };
 
 } // namespace OSGUIsh
@@ -0,0 +1,93 @@
+/******************************************************************************\
+* PickingStats.hpp                                                             *
+* Per-frame statistics about the cost of picking and dispatching events.       *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#ifndef _OSGUISH_PICKING_STATS_HPP_
+#define _OSGUISH_PICKING_STATS_HPP_
+
+#include <cstddef>
+
+namespace osg { class Stats; }
+namespace osgViewer { class StatsHandler; class ViewerBase; }
+
+
+namespace OSGUIsh
+{
+   /**
+    * The name of the \c osg::Stats collection enabling OSGUIsh picking
+    * statistics. When <tt>collectStats("osguish")</tt> is \c true for the
+    * viewer stats, the \c EventHandler records a \c PickingStats for every
+    * frame there.
+    */
+   extern const char* const PICKING_STATS_NAME;
+
+   /**
+    * What was spent picking and dispatching events during one frame. All
+    * times are in seconds.
+    */
+   struct PickingStats
+   {
+      /// Constructs a \c PickingStats with everything zeroed.
+      PickingStats() { reset(); }
+
+      /// Zeroes everything.
+      void reset();
+
+      /**
+       * Writes these values as attributes of a given frame in an \c
+       * osg::Stats. The attribute names all start with "OSGUIsh".
+       */
+      void write(osg::Stats& stats, unsigned frameNumber) const;
+
+      /// When picking started, in \c osg::Timer::time_s() units.
+      double pickBeginTime;
+
+      /// When picking ended, in \c osg::Timer::time_s() units.
+      double pickEndTime;
+
+      /// The number of node masks tried when picking.
+      std::size_t masksTried;
+
+      /// The number of nodes visited by the \c osgUtil::IntersectionVisitor.
+      std::size_t nodesVisited;
+
+      /// The number of intersections found, before choosing one.
+      std::size_t rawHits;
+
+      /// Time spent looking for the observed node in the hit node path.
+      double observedNodeTime;
+
+      /**
+       * The number of registered node lookups done while looking for the
+       * observed node. This is at most the length of the hit node path.
+       */
+      std::size_t observedNodeLookups;
+
+      /**
+       * Time spent dispatching events (that is, running handlers) since the
+       * previous frame.
+       */
+      double dispatchTime;
+   };
+
+
+
+   /**
+    * Adds lines showing the OSGUIsh picking statistics to a \c
+    * osgViewer::StatsHandler, and enables their collection in the viewer
+    * stats. The pick time is drawn as a bar, so that it can be compared
+    * with the event, update, cull and draw bars.
+    */
+   void AddPickingStatsLines(osgViewer::StatsHandler& statsHandler,
+                             osgViewer::ViewerBase& viewer);
+
+} // namespace OSGUIsh
+
+#endif // _OSGUISH_PICKING_STATS_HPP_
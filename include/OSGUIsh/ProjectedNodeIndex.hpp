@@ -0,0 +1,218 @@
+/******************************************************************************\
+* ProjectedNodeIndex.hpp                                                       *
+* A 2D index of nodes, by the position of their centers on the screen.         *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#ifndef _OSGUISH_PROJECTED_NODE_INDEX_HPP_
+#define _OSGUISH_PROJECTED_NODE_INDEX_HPP_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <osg/Camera>
+#include <osg/Matrixd>
+#include <osg/Vec2>
+#include <osg/Vec3d>
+#include <OSGUIsh/Types.hpp>
+
+
+namespace OSGUIsh
+{
+   /**
+    * An index of nodes by the position of their centers projected on the
+    * screen (in window coordinates). The screen is divided in a uniform grid
+    * of square cells, so that finding the node nearest to some point only
+    * looks at the cells around it, however many nodes are indexed.
+    *
+    * The world position of each node is computed when it is added (or when
+    * \c updateNode() is called, for nodes that move). When the camera
+    * moves, all the nodes must be projected again; \c update() does this
+    * incrementally, a limited number of nodes at a time, so that the work
+    * can be spread over a few frames. The grid is double buffered: queries
+    * use the last complete grid while the next one is built, so they never
+    * wait for a projection, but may see the camera as it was a few frames
+    * ago. (Only the very first query projects all nodes at once.)
+    * @note The position of a node is taken along the path through the first
+    *       parent of each node (as for <tt>getParent(0)</tt>). Nodes
+    *       instanced in many places in the scene graph are indexed at one of
+    *       them only.
+    * @see SpatialFocusPolicy
+    */
+   class ProjectedNodeIndex
+   {
+      public:
+         /// The screen-space directions to look for nodes.
+         enum Direction
+         {
+            LEFT,
+            RIGHT,
+            UP,
+            DOWN
+         };
+
+         /**
+          * Constructs a \c ProjectedNodeIndex.
+          * @param camera The camera whose view the index is about.
+          * @param cellSize The size, in pixels, of the grid cells.
+          */
+         ProjectedNodeIndex(osg::Camera* camera, float cellSize = 64.0f);
+
+         /// Adds a node to the index. Adding a node twice has no effect.
+         void addNode(const NodePtr& node);
+
+         /// Removes a node from the index.
+         void removeNode(const NodePtr& node);
+
+         /**
+          * Recomputes the world position of a node, which must be called
+          * after the node (or any of its ancestors) moves.
+          */
+         void updateNode(const NodePtr& node);
+
+         /**
+          * Projects at most \c maxNodes nodes into the grid being built. If
+          * no grid is being built and the camera moved since the current one
+          * was, starts a new one, for the current camera. Once all nodes are
+          * projected, the new grid replaces the current one. This is meant to
+          * be called once per frame.
+          */
+         void update(std::size_t maxNodes);
+
+         /**
+          * Returns the node whose center is the nearest to the center of \c
+          * from in a given direction. Nodes far from the line going from \c
+          * from in that direction are penalized. If \c from is not in the
+          * index (or is not on the screen), returns the node nearest to the
+          * center of the screen, whatever the direction.
+          * @return The node found; \c NULL if there are no nodes on the
+          *         screen in the given direction.
+          */
+         NodePtr findNearest(const NodePtr& from, Direction direction);
+
+         /// Returns the number of nodes in the index.
+         std::size_t getNumNodes() const { return entries_.size(); }
+
+      private:
+         /// An indexed node.
+         struct Entry_t
+         {
+            /// The node.
+            NodePtr node;
+
+            /// The center of the node, in world coordinates.
+            osg::Vec3d center;
+         };
+
+         /// Where a node is in a grid.
+         struct Projection_t
+         {
+            /// The center of the node, in window coordinates.
+            osg::Vec2 position;
+
+            /// The grid cell the node is in; -1 if it is not on the screen.
+            int cell;
+         };
+
+         /// The nodes projected with a given camera.
+         struct Grid_t
+         {
+            /// The cells; each one lists the indices of the entries in it.
+            std::vector<std::vector<std::size_t> > cells;
+
+            /// The projection of each entry, with the same indices.
+            std::vector<Projection_t> projections;
+
+            /// The number of columns in the grid.
+            int numColumns;
+
+            /// The number of rows in the grid.
+            int numRows;
+
+            /// The lower left corner of the viewport, in window coordinates.
+            osg::Vec2 origin;
+
+            /// The size of the viewport.
+            osg::Vec2 size;
+
+            /// The view and projection matrices used to project the nodes.
+            osg::Matrixd viewProjection;
+         };
+
+         /// Checks if the camera moved since \c grid was started.
+         bool cameraMoved(const Grid_t& grid) const;
+
+         /// Empties \c *back_ and starts projecting with the current camera.
+         void startProjection();
+
+         /**
+          * Makes sure that there is a complete grid to query, projecting all
+          * nodes if needed.
+          */
+         void finishProjection();
+
+         /// Projects \c entries_[i] and inserts it in \c grid.
+         void project(Grid_t& grid, std::size_t i);
+
+         /// Removes \c entries_[i] from the cell of \c grid it is in (if any).
+         void removeFromCell(Grid_t& grid, std::size_t i);
+
+         /// Projects \c entries_[i] in the grids it must be in.
+         void projectInGrids(std::size_t i);
+
+         /// Removes \c entries_[i] from all grids.
+         void removeFromGrids(std::size_t i);
+
+         /**
+          * Computes the center, in world coordinates, of a node, following
+          * the first parent of each node up to the root.
+          */
+         static osg::Vec3d computeCenter(const osg::Node& node);
+
+         /// The camera whose view the index is about.
+         osg::ref_ptr<osg::Camera> camera_;
+
+         /// The size, in pixels, of the grid cells.
+         float cellSize_;
+
+         /// The indexed nodes.
+         std::vector<Entry_t> entries_;
+
+         /// Maps each indexed node to its position in \c entries_.
+         boost::unordered_map<const osg::Node*, std::size_t> entryIndices_;
+
+         /// The two grids, pointed to by \c front_ and \c back_.
+         Grid_t grids_[2];
+
+         /// The grid used by queries, complete if \c frontValid_.
+         Grid_t* front_;
+
+         /// The grid being built, if \c building_.
+         Grid_t* back_;
+
+         /// Has any grid been completed yet?
+         bool frontValid_;
+
+         /// Is \c *back_ being built?
+         bool building_;
+
+         /**
+          * The number of entries projected in \c *back_. The ones with an
+          * index smaller than this are in it.
+          */
+         std::size_t numProjected_;
+   };
+
+
+
+   /// A (smart) pointer to a \c ProjectedNodeIndex.
+   typedef boost::shared_ptr<ProjectedNodeIndex> ProjectedNodeIndexPtr;
+
+} // namespace OSGUIsh
+
+#endif // _OSGUISH_PROJECTED_NODE_INDEX_HPP_
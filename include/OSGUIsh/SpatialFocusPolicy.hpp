@@ -0,0 +1,96 @@
+/******************************************************************************\
+* SpatialFocusPolicy.hpp                                                       *
+* Moves the focus to the nearest node in the direction of an arrow key.        *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#ifndef _OSGUISH_SPATIAL_FOCUS_POLICY_HPP_
+#define _OSGUISH_SPATIAL_FOCUS_POLICY_HPP_
+
+#include <OSGUIsh/FocusPolicy.hpp>
+#include <OSGUIsh/ProjectedNodeIndex.hpp>
+
+
+namespace OSGUIsh
+{
+   /**
+    * A focus policy that moves the focus with the arrow keys: pressing one
+    * of them moves the focus to the nearest node on the screen in that
+    * direction. Only the nodes in a \c ProjectedNodeIndex are candidates,
+    * and the index is kept up to date with the camera at every frame,
+    * projecting at most a given number of nodes per frame.
+    *
+    * As with other policies, the \c EventHandler creates the policy, so
+    * it is set with a \c SpatialFocusPolicyFactory, as in
+    * <tt>setKeyboardFocusPolicy(SpatialFocusPolicyFactory(index))</tt>.
+    * @note When no indexed node has the focus, an arrow key puts the focus
+    *       on the node nearest to the center of the screen.
+    */
+   class SpatialFocusPolicy: public FocusPolicy
+   {
+      public:
+         /**
+          * Constructs a \c SpatialFocusPolicy.
+          * @param focusedNode The node with focus (see \c FocusPolicy).
+          * @param index The index with the nodes that can get the focus.
+          * @param nodesPerFrame The maximum number of nodes projected per
+          *        frame after the camera moves (see \c
+          *        ProjectedNodeIndex::update()).
+          */
+         SpatialFocusPolicy(NodePtr& focusedNode, ProjectedNodeIndexPtr index,
+                            std::size_t nodesPerFrame = 4096)
+            : FocusPolicy(focusedNode), index_(index),
+              nodesPerFrame_(nodesPerFrame)
+         { }
+
+         // (inherits documentation)
+         virtual void updateFocus(const osgGA::GUIEventAdapter& ea,
+                                  const NodePtr& nodeUnderMouse);
+
+      private:
+         /// The index with the nodes that can get the focus.
+         ProjectedNodeIndexPtr index_;
+
+         /// The maximum number of nodes projected per frame.
+         std::size_t nodesPerFrame_;
+   };
+
+
+
+   /// A \c FocusPolicyFactory creating <tt>SpatialFocusPolicy</tt>s.
+   class SpatialFocusPolicyFactory: public FocusPolicyFactory
+   {
+      public:
+         /**
+          * Constructs a \c SpatialFocusPolicyFactory. The parameters are
+          * passed to the policies created (see \c
+          * SpatialFocusPolicy::SpatialFocusPolicy()).
+          */
+         SpatialFocusPolicyFactory(ProjectedNodeIndexPtr index,
+                                   std::size_t nodesPerFrame = 4096)
+            : index_(index), nodesPerFrame_(nodesPerFrame)
+         { }
+
+         // (inherits docs)
+         virtual FocusPolicyPtr create(NodePtr& focusedNode) const
+         {
+            return FocusPolicyPtr(
+               new SpatialFocusPolicy(focusedNode, index_, nodesPerFrame_));
+         }
+
+      private:
+         /// The index passed to the policies.
+         ProjectedNodeIndexPtr index_;
+
+         /// The number of nodes projected per frame by the policies.
+         std::size_t nodesPerFrame_;
+   };
+
+} // namespace OSGUIsh
+
+#endif // _OSGUISH_SPATIAL_FOCUS_POLICY_HPP_
@@ -0,0 +1,106 @@
+/******************************************************************************\
+* StaticEventHandler.hpp                                                       *
+* An event handler with focus policies chosen at compile time.                 *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#ifndef _OSGUISH_STATIC_EVENT_HANDLER_HPP_
+#define _OSGUISH_STATIC_EVENT_HANDLER_HPP_
+
+#include <stdexcept>
+#include <OSGUIsh/EventHandler.hpp>
+
+
+namespace OSGUIsh
+{
+   /**
+    * An \c EventHandler whose focus policies are fixed at compile time. The
+    * regular \c EventHandler updates the focus through two <tt>boost::
+    * shared_ptr<FocusPolicy></tt>s and two virtual calls for every event
+    * OSG sends (including every \c FRAME). Here, the policies are members,
+    * called with their static types, so that their code can be inlined; the
+    * updates done by a \c ManualFocusPolicy, for instance, vanish entirely.
+    * One virtual call per event remains: the one to \c updateFocus() itself,
+    * through which \c EventHandler::handle() reaches the policies.
+    *
+    * Usage is the same as with \c EventHandler, except that the focus
+    * policies are template arguments, and cannot be changed later: \c
+    * setKeyboardFocusPolicy() and \c setMouseWheelFocusPolicy() throw, even
+    * when called through an <tt>EventHandler&</tt>. For example,
+    * <tt>StaticEventHandler<ManualFocusPolicy, MouseOverFocusPolicy></tt>.
+    * @param KbdPolicy The focus policy for keyboard events.
+    * @param WheelPolicy The focus policy for mouse wheel events.
+    * @note The policies don't need to derive from \c FocusPolicy: any class
+    *       constructible from a <tt>NodePtr&</tt> (the focused node, to be
+    *       kept up to date) and with an <tt>updateFocus(const
+    *       osgGA::GUIEventAdapter&, const NodePtr&)</tt> member will do.
+    */
+   template <class KbdPolicy, class WheelPolicy>
+   class StaticEventHandler: public EventHandler
+   {
+      public:
+         /**
+          * Constructs a \c StaticEventHandler.
+          * @param pickerRadius The radius of the picking region (see \c
+          *        EventHandler::EventHandler()).
+          */
+         StaticEventHandler(double pickerRadius = 0.0)
+            : EventHandler(pickerRadius, NoPolicyFactory_t(),
+                           NoPolicyFactory_t()),
+              kbdPolicy_(getKeyboardFocusRef()),
+              wheelPolicy_(getMouseWheelFocusRef())
+         { }
+
+         /// Throws: the policies are fixed at compile time.
+         virtual void setKeyboardFocusPolicy(const FocusPolicyFactory&)
+         {
+            throw std::runtime_error(
+               "The focus policies of a StaticEventHandler cannot be changed");
+         }
+
+         /// Throws: the policies are fixed at compile time.
+         virtual void setMouseWheelFocusPolicy(const FocusPolicyFactory&)
+         {
+            throw std::runtime_error(
+               "The focus policies of a StaticEventHandler cannot be changed");
+         }
+
+      protected:
+         // (inherits documentation)
+         virtual void updateFocus(const osgGA::GUIEventAdapter& ea,
+                                  const NodePtr& nodeUnderMouse)
+         {
+            // Qualified calls are not virtual, so they can be inlined
+            kbdPolicy_.KbdPolicy::updateFocus(ea, nodeUnderMouse);
+            wheelPolicy_.WheelPolicy::updateFocus(ea, nodeUnderMouse);
+         }
+
+      private:
+         /**
+          * A factory creating no policy at all, so that the base class doesn't
+          * allocate runtime policies that would never be used.
+          */
+         class NoPolicyFactory_t: public FocusPolicyFactory
+         {
+            public:
+               virtual FocusPolicyPtr create(NodePtr&) const
+               {
+                  return FocusPolicyPtr();
+               }
+         };
+
+         /// The focus policy for keyboard-related events.
+         KbdPolicy kbdPolicy_;
+
+         /// The focus policy for mouse wheel-related events.
+         WheelPolicy wheelPolicy_;
+   };
+
+} // namespace OSGUIsh
+
+#endif // _OSGUISH_STATIC_EVENT_HANDLER_HPP_
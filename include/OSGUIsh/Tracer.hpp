@@ -0,0 +1,91 @@
+/******************************************************************************\
+* Tracer.hpp                                                                   *
+* Writes Chrome trace-event files with the time spent in OSGUIsh.              *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#ifndef _OSGUISH_TRACER_HPP_
+#define _OSGUISH_TRACER_HPP_
+
+#include <fstream>
+#include <string>
+#include <boost/shared_ptr.hpp>
+
+
+namespace OSGUIsh
+{
+   /**
+    * Writes spans of time to a file in the Chrome trace-event JSON format,
+    * which can be opened in \c chrome://tracing or in Perfetto. Once set with
+    * \c EventHandler::setTracer(), spans are recorded for every call to \c
+    * handle(), every picking mask tried, the search for the observed node,
+    * the focus policy updates and every signal invocation (annotated with the
+    * node name).
+    *
+    * Timestamps come from \c osg::Timer::time_u(), the same clock used by
+    * OSG for its frame statistics.
+    *
+    * Only the thread calling \c EventHandler::handle() is traced.
+    */
+   class Tracer
+   {
+      public:
+         /**
+          * Constructs the \c Tracer, creating (or truncating) a file.
+          * @param fileName The trace file to write.
+          */
+         Tracer(const std::string& fileName);
+
+         /// Destroys the \c Tracer, closing the file (see \c close()).
+         ~Tracer();
+
+         /// Is the output file fine?
+         bool isValid() const { return file_.good(); }
+
+         /// Returns the current time, in microseconds, as used in the trace.
+         static double now();
+
+         /**
+          * Adds a span to the trace.
+          * @param name The name of the span.
+          * @param category The category of the span.
+          * @param begin When the span started, as returned by \c now().
+          * @param end When the span ended, as returned by \c now().
+          * @param argName The name of an argument annotating the span. No
+          *        argument is added if this is \c NULL.
+          * @param argValue The value of the argument.
+          */
+         void addSpan(const char* name, const char* category, double begin,
+                      double end, const char* argName = 0,
+                      const std::string& argValue = "");
+
+         /**
+          * Finishes writing the trace and closes the file. Spans added after
+          * this are ignored.
+          */
+         void close();
+
+      private:
+         /// Writes a string as a JSON string (quoted and escaped).
+         void writeString(const std::string& str);
+
+         /// The output file.
+         std::ofstream file_;
+
+         /// Was a span written already? (Used to place the commas.)
+         bool hasSpans_;
+   };
+
+
+
+   /// A (smart) pointer to a \c Tracer.
+   typedef boost::shared_ptr<Tracer> TracerPtr;
+
+} // namespace OSGUIsh
+
+#endif // _OSGUISH_TRACER_HPP_
@@ -12,6 +12,7 @@
 #ifndef _OSGUISH_TYPES_HPP_
 #define _OSGUISH_TYPES_HPP_
 
+#include <vector>
 #include <osg/Node>
 #include <osgUtil/LineSegmentIntersector>
 #include <osgUtil/PolytopeIntersector>
@@ -22,6 +23,99 @@ namespace OSGUIsh
    /// A (smart) pointer to a scene graph node.
    typedef osg::ref_ptr<osg::Node> NodePtr;
 
+   /**
+    * A mouse position reported by OSG (in a \c MOVE or \c DRAG event)
+    * between two frames.
+    * @see HandlerParams::motion
+    */
+   struct MotionSample_t
+   {
+      /// The mouse position, as given by \c GUIEventAdapter::getX().
+      float x;
+
+      /// The mouse position, as given by \c GUIEventAdapter::getY().
+      float y;
+
+      /// The horizontal mouse position, normalized to the [-1, 1] range.
+      float xNormalized;
+
+      /// The vertical mouse position, normalized to the [-1, 1] range.
+      float yNormalized;
+
+      /// The time of the event, as given by \c GUIEventAdapter::getTime().
+      double time;
+
+      /// The mouse buttons pressed, as in \c GUIEventAdapter::getButtonMask().
+      unsigned buttonMask;
+   };
+
+   /// A sequence of mouse positions, oldest first.
+   typedef std::vector<MotionSample_t> MotionSamples_t;
+
+   /**
+    * How the mouse position is turned into a 3D point while a node is being
+    * dragged. The plane or axis passes through the point where the node was
+    * hit when the drag started.
+    * @see EventHandler::setDragConstraint()
+    */
+   struct DragConstraint_t
+   {
+      /// The kinds of constraint.
+      enum Kind
+      {
+         PLANE,      ///< A plane with a given normal.
+         AXIS,       ///< A line with a given direction.
+         VIEW_PLANE  ///< A plane facing the camera (at the drag start).
+      };
+
+      /// The kind of constraint.
+      Kind kind;
+
+      /**
+       * The normal of the plane, or the direction of the axis, in the world
+       * coordinate system. Unused for \c VIEW_PLANE.
+       */
+      osg::Vec3d direction;
+
+      /// Constructs a constraint to a plane with a given normal.
+      static DragConstraint_t MakePlane(const osg::Vec3d& normal)
+      {
+         DragConstraint_t c = { PLANE, normal };
+         return c;
+      }
+
+      /// Constructs a constraint to an axis with a given direction.
+      static DragConstraint_t MakeAxis(const osg::Vec3d& direction)
+      {
+         DragConstraint_t c = { AXIS, direction };
+         return c;
+      }
+
+      /// Constructs a constraint to the plane facing the camera.
+      static DragConstraint_t MakeViewPlane()
+      {
+         DragConstraint_t c = { VIEW_PLANE, osg::Vec3d() };
+         return c;
+      }
+   };
+
+   /**
+    * The state of a drag, passed to the handlers of drag events. All points
+    * are in the world coordinate system.
+    * @see HandlerParams::drag
+    */
+   struct DragInfo_t
+   {
+      /// Where the node was hit when the drag started.
+      osg::Vec3d startPoint;
+
+      /// The mouse position, projected on the drag constraint.
+      osg::Vec3d point;
+
+      /// The value of \c point at the previous drag event.
+      osg::Vec3d previousPoint;
+   };
+
    /**
     * An intersection (a hit when picking). OSG has types similar to this one,
     * but, unfortunately, they are directly coupled with the different
@@ -83,6 +177,128 @@ namespace OSGUIsh
          osg::Vec3d localIntersectionNormal;
    };
 
+
+
+   /**
+    * A lightweight, read-only view of an intersection. Unlike \c
+    * Intersection_t, this doesn't copy anything: it just refers to the
+    * intersection data produced by an OSG intersector (or to an \c
+    * Intersection_t), and the derived values (like the world intersection
+    * point) are computed only when (and if) they are first requested.
+    *
+    * This is what OSGUIsh passes to event handlers, since most handlers don't
+    * look at the intersection at all. If you need to keep the intersection
+    * data for later, call \c toIntersection() to get a copy of it: the view
+    * itself is valid only while the event is being handled.
+    */
+   class IntersectionView_t
+   {
+      public:
+         /// Constructs an invalid view, which doesn't refer to any hit.
+         IntersectionView_t();
+
+         /// Constructs a view of an \c osgUtil::LineSegmentIntersector hit.
+         explicit IntersectionView_t(
+            const osgUtil::LineSegmentIntersector::Intersection& hit);
+
+         /// Constructs a view of an \c osgUtil::PolytopeIntersector hit.
+         explicit IntersectionView_t(
+            const osgUtil::PolytopeIntersector::Intersection& hit);
+
+         /// Constructs a view of an \c Intersection_t.
+         explicit IntersectionView_t(const Intersection_t& hit);
+
+         /// Checks whether this view refers to an actual hit.
+         bool valid() const { return source_ != SOURCE_NONE; }
+
+         /**
+          * Returns the node path of the intersected low-level node.
+          * @see Intersection_t::nodePath
+          */
+         const osg::NodePath& getNodePath() const;
+
+         /// Returns the intersection point, in the world coordinate system.
+         const osg::Vec3d& getWorldIntersectionPoint() const;
+
+         /**
+          * Returns the object normal vector at the intersection point, in the
+          * world coordinate system. This is a null vector for hits obtained
+          * with a positive picking radius.
+          */
+         const osg::Vec3d& getWorldIntersectionNormal() const;
+
+         /**
+          * Returns the intersection point, in the local (object) coordinate
+          * system.
+          */
+         const osg::Vec3d& getLocalIntersectionPoint() const;
+
+         /**
+          * Returns the object normal vector at the intersection point, in the
+          * local (object) coordinate system. This is a null vector for hits
+          * obtained with a positive picking radius.
+          */
+         const osg::Vec3d& getLocalIntersectionNormal() const;
+
+         /// Returns a copy of the intersection data.
+         Intersection_t toIntersection() const;
+
+         /**
+          * Copies the intersection data to \c dest. Unlike \c
+          * toIntersection(), this reuses the memory already allocated by \c
+          * dest.
+          */
+         void copyTo(Intersection_t& dest) const;
+
+      private:
+         /// The possible kinds of data a view can refer to.
+         enum Source
+         {
+            SOURCE_NONE,          ///< Nothing; an invalid view.
+            SOURCE_LINE,          ///< A \c LineSegmentIntersector hit.
+            SOURCE_POLYTOPE,      ///< A \c PolytopeIntersector hit.
+            SOURCE_INTERSECTION   ///< An \c Intersection_t.
+         };
+
+         /// Flags telling which of the cached values were computed already.
+         enum CachedValue
+         {
+            CACHED_WORLD_POINT = 1 << 0,
+            CACHED_WORLD_NORMAL = 1 << 1,
+            CACHED_LOCAL_POINT = 1 << 2,
+            CACHED_LOCAL_NORMAL = 1 << 3
+         };
+
+         /// The kind of data this view refers to.
+         Source source_;
+
+         /**
+          * The data this view refers to. Which member is used depends on \c
+          * source_.
+          */
+         union
+         {
+            const osgUtil::LineSegmentIntersector::Intersection* line;
+            const osgUtil::PolytopeIntersector::Intersection* polytope;
+            const Intersection_t* intersection;
+         } hit_;
+
+         /// A combination of \c CachedValue flags.
+         mutable unsigned cached_;
+
+         /// The world intersection point, if already computed.
+         mutable osg::Vec3d worldPoint_;
+
+         /// The world normal, if already computed.
+         mutable osg::Vec3d worldNormal_;
+
+         /// The local intersection point, if already computed.
+         mutable osg::Vec3d localPoint_;
+
+         /// The local normal, if already computed.
+         mutable osg::Vec3d localNormal_;
+   };
+
 } // namespace OSGUIsh
 
 #endif // _OSGUISH_TYPES_HPP_
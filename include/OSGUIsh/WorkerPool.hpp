@@ -0,0 +1,178 @@
+/******************************************************************************\
+* WorkerPool.hpp                                                               *
+* A pool of worker threads used to run event handlers asynchronously.          *
+*                                                                              *
+* Leandro Motta Barros                                                         *
+*                                                                              *
+* This program is distributed under the OpenSceneGraph Public License. You     *
+* should have received a copy of it with the source distribution, in a file    *
+* named 'COPYING.txt'.                                                         *
+\******************************************************************************/
+
+#ifndef _OSGUISH_WORKER_POOL_HPP_
+#define _OSGUISH_WORKER_POOL_HPP_
+
+#include <deque>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <OpenThreads/Condition>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/Thread>
+
+
+namespace OSGUIsh
+{
+   /**
+    * A pool of worker threads, used to run expensive event handlers out of
+    * the frame thread (see \c EventHandler::makeAsyncSlot()).
+    *
+    * Every task is enqueued with a key, and tasks with the same key always run
+    * in the order they were enqueued, one after the other. (Internally, a key
+    * is always mapped to the same worker thread.) OSGUIsh uses the node
+    * generating the event as the key, so that events for a given node are
+    * handled in order -- say, a "mouse enter" is always handled before the
+    * "mouse leave" that follows it.
+    *
+    * Tasks running on worker threads must not touch the scene graph. Instead,
+    * they can post tasks to be run in the main thread, through a \c
+    * MainThreadQueue.
+    *
+    * Tasks must not keep the pool alive (through a \c WorkerPoolPtr): the
+    * pool would be destroyed by one of its own workers, which would then try
+    * to join itself.
+    */
+   class WorkerPool
+   {
+      public:
+         /// A task to be run, either by a worker or by the main thread.
+         typedef boost::function<void()> Task_t;
+
+         /**
+          * Constructs a \c WorkerPool, and starts its threads.
+          * @param numThreads The number of worker threads. If zero, uses one
+          *        thread less than the number of processors (but at least
+          *        one).
+          */
+         WorkerPool(unsigned numThreads = 0);
+
+         /**
+          * Destroys the \c WorkerPool. Tasks already enqueued are run before
+          * the worker threads are joined. Must not be called from a worker
+          * thread of this pool.
+          */
+         ~WorkerPool();
+
+         /**
+          * Enqueues a task to be run by a worker thread.
+          * @param key Tasks with the same key run in the order they were
+          *        enqueued.
+          * @param task The task to run.
+          */
+         void enqueue(std::size_t key, const Task_t& task);
+
+         /// Returns the number of worker threads in the pool.
+         std::size_t getNumThreads() const { return workers_.size(); }
+
+      private:
+         /// A worker thread, with its own queue of tasks.
+         class Worker: public OpenThreads::Thread
+         {
+            public:
+               /// Constructs the \c Worker. (Doesn't start the thread.)
+               Worker();
+
+               /// Enqueues a task to be run by this worker.
+               void enqueue(const Task_t& task);
+
+               /**
+                * Asks the worker to finish. It will run all tasks already
+                * enqueued before exiting.
+                */
+               void stop();
+
+               /// The thread body.
+               virtual void run();
+
+            private:
+               /// The tasks waiting to be run.
+               std::deque<Task_t> tasks_;
+
+               /// Protects \c tasks_ and \c done_.
+               OpenThreads::Mutex mutex_;
+
+               /// Signaled when a task is enqueued or \c stop() is called.
+               OpenThreads::Condition condition_;
+
+               /// Was \c stop() called?
+               bool done_;
+         };
+
+         /// The worker threads.
+         std::vector<Worker*> workers_;
+
+         // Non-copyable
+         WorkerPool(const WorkerPool&);
+         WorkerPool& operator=(const WorkerPool&);
+   };
+
+
+
+   /// A (smart) pointer to a \c WorkerPool.
+   typedef boost::shared_ptr<WorkerPool> WorkerPoolPtr;
+
+
+
+   /**
+    * A queue of tasks to be run in the main thread, posted by tasks running
+    * in a \c WorkerPool. Each \c EventHandler owns one, and runs its tasks
+    * at every frame, regardless of which pool posted them.
+    */
+   class MainThreadQueue
+   {
+      public:
+         /// A task to be run in the main thread.
+         typedef WorkerPool::Task_t Task_t;
+
+         /// Constructs an empty \c MainThreadQueue.
+         MainThreadQueue() { }
+
+         /**
+          * Posts a task to be run in the main thread, by the next call to \c
+          * runTasks(). This can be called from any thread.
+          */
+         void post(const Task_t& task);
+
+         /**
+          * Runs (in the calling thread, supposedly the main one) all tasks
+          * posted with \c post().
+          * @return The number of tasks run.
+          */
+         std::size_t runTasks();
+
+      private:
+         /// The tasks waiting to be run.
+         std::vector<Task_t> tasks_;
+
+         /**
+          * A buffer swapped with \c tasks_, so that tasks can be run without
+          * holding \c mutex_.
+          */
+         std::vector<Task_t> runningTasks_;
+
+         /// Protects \c tasks_.
+         OpenThreads::Mutex mutex_;
+
+         // Non-copyable
+         MainThreadQueue(const MainThreadQueue&);
+         MainThreadQueue& operator=(const MainThreadQueue&);
+   };
+
+
+
+   /// A (smart) pointer to a \c MainThreadQueue.
+   typedef boost::shared_ptr<MainThreadQueue> MainThreadQueuePtr;
+
+} // namespace OSGUIsh
+
+#endif // _OSGUISH_WORKER_POOL_HPP_